@@ -1,35 +1,452 @@
 #include "lib/parser.h"
-#include <iostream>
+#include "lib/embed.h"
+#include "lib/flat.h"
+
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
 #include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <thread>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define OMFL_MMAP
+#endif
 
 using namespace omfl;
 
-void XML(Section* current_section, std::fstream& file) {
-    file << '<' << current_section->GetName() << '>' << "\n";
-    std::vector<Variable*> cur = current_section->GetArr();
-    for (int i = 0; i < cur.size(); i++) {
-        if (cur[i]->IsInt()) {
-            file << '<' << cur[i]->GetName() << '>' << cur[i]->AsInt()
-                 << "</" << cur[i]->GetName() << '>' << "\n";
-        } else if (cur[i]->IsString()) {
-            file << '<' << cur[i]->GetName() << '>' << cur[i]->AsString()
-                 << "</" << cur[i]->GetName() << '>' << "\n";
-        } else if (cur[i]->IsFloat()) {
-            file << '<' << cur[i]->GetName() << '>' << cur[i]->AsFloat()
-                 << "</" << cur[i]->GetName() << '>' << "\n";
-        } else if (cur[i]->IsBool()) {
-            file << '<' << cur[i]->GetName() << '>' << cur[i]->AsBool() << "</" << cur[i]->GetName() << '>' << "\n";
-        }
-    }
-    std::vector <Section*> sections = current_section->GetSectionChild();
-    for (int i = 0; i < sections.size(); i++){
-        XML(sections[i], file);
-    }
-    file << "</" << current_section->GetName() << '>' << "\n";
-}
+namespace {
+
+    enum FORMAT {
+        XML = 1,
+        JSON
+    };
+
+    struct Options {
+        size_t threads = std::max(1u, std::thread::hardware_concurrency());
+        FORMAT format = XML;
+        bool map_input = true;
+        std::filesystem::path output_dir;
+        std::vector<std::filesystem::path> inputs;
+    };
+
+    struct Job {
+        std::filesystem::path input;
+        std::filesystem::path output;
+    };
+
+    struct Stats {
+        size_t converted = 0;
+        size_t failed = 0;
+        uint64_t bytes_in = 0;
+        uint64_t bytes_out = 0;
+    };
+
+    // Read-only view of a whole input file, memory-mapped where the platform
+    // allows it and read into memory otherwise.
+    class InputFile {
+        const char* data_ = nullptr;
+        size_t size_ = 0;
+        bool mapped_ = false;
+        std::string buffer_;
+
+    public:
+        InputFile() = default;
+
+        InputFile(const InputFile&) = delete;
+
+        InputFile& operator=(const InputFile&) = delete;
+
+        ~InputFile() {
+#ifdef OMFL_MMAP
+            if (mapped_) {
+                munmap(const_cast<char*>(data_), size_);
+            }
+#endif
+        }
+
+        bool Open(const std::filesystem::path& path, bool map_input) {
+#ifdef OMFL_MMAP
+            if (map_input) {
+                int fd = open(path.c_str(), O_RDONLY);
+                if (fd < 0) {
+                    return false;
+                }
+                struct stat info{};
+                if (fstat(fd, &info) != 0) {
+                    close(fd);
+                    return false;
+                }
+                size_ = static_cast<size_t>(info.st_size);
+                if (size_ > 0) {
+                    void* data = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+                    if (data == MAP_FAILED) {
+                        close(fd);
+                        return false;
+                    }
+                    madvise(data, size_, MADV_SEQUENTIAL);
+                    data_ = static_cast<const char*>(data);
+                    mapped_ = true;
+                }
+                close(fd);
+                return true;
+            }
+#endif
+            std::ifstream file(path, std::ios::binary);
+            if (!file) {
+                return false;
+            }
+            buffer_.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+            data_ = buffer_.data();
+            size_ = buffer_.size();
+            return true;
+        }
+
+        [[nodiscard]] std::string_view View() const {
+            return std::string_view(data_, size_);
+        }
+    };
+
+    void AppendEscaped(std::string& out, std::string_view text, FORMAT format) {
+        for (char c : text) {
+            if (format == XML) {
+                if (c == '<') {
+                    out += "&lt;";
+                } else if (c == '>') {
+                    out += "&gt;";
+                } else if (c == '&') {
+                    out += "&amp;";
+                } else {
+                    out.push_back(c);
+                }
+            } else if (c == '\"' || c == '\\') {
+                out.push_back('\\');
+                out.push_back(c);
+            } else if (static_cast<unsigned char>(c) < 0x20) {
+                char escape[8];
+                std::snprintf(escape, sizeof(escape), "\\u%04x", c);
+                out += escape;
+            } else {
+                out.push_back(c);
+            }
+        }
+    }
+
+    void AppendScalar(std::string& out, const FlatDocument& document, const FlatVariable& variable, FORMAT format) {
+        char number[32];
+        if (variable.type == INT) {
+            out.append(number, std::to_chars(number, number + sizeof(number), variable.int_value).ptr);
+        } else if (variable.type == FLOAT) {
+            out.append(number, std::snprintf(number, sizeof(number), "%.9g", variable.float_value));
+        } else if (variable.type == BOOL) {
+            out += format == XML ? (variable.bool_value ? "1" : "0") : (variable.bool_value ? "true" : "false");
+        } else if (variable.type == STRING) {
+            if (format == JSON) {
+                out.push_back('\"');
+            }
+            AppendEscaped(out, document.Text(variable.value), format);
+            if (format == JSON) {
+                out.push_back('\"');
+            }
+        }
+    }
+
+    // The writers below keep the open arrays and sections on explicit
+    // stacks: inputs are untrusted and may nest far deeper than the call
+    // stack of a worker thread allows.
+    struct OpenArray {
+        const FlatVariable* array;
+        uint32_t next;
+    };
+
+    struct OpenSection {
+        const FlatSection* section;
+        uint32_t next;
+        bool empty;
+    };
+
+    void XmlValue(const FlatDocument& document, const FlatVariable& variable, std::string_view name, std::string& out) {
+        out += '<';
+        out += name;
+        out += '>';
+        if (variable.type != ARRAY) {
+            AppendScalar(out, document, variable, XML);
+        } else {
+            out += '\n';
+            std::vector<OpenArray> stack{{&variable, 0}};
+            while (stack.size() > 1 || stack.back().next < variable.value.count) {
+                OpenArray& top = stack.back();
+                if (top.next == top.array->value.count) {
+                    out += "</item>\n";
+                    stack.pop_back();
+                    continue;
+                }
+                const FlatVariable& element = document.Elements()[top.array->value.first + top.next++];
+                if (element.type == ARRAY) {
+                    out += "<item>\n";
+                    stack.push_back({&element, 0});
+                } else {
+                    out += "<item>";
+                    AppendScalar(out, document, element, XML);
+                    out += "</item>\n";
+                }
+            }
+        }
+        out += "</";
+        out += name;
+        out += ">\n";
+    }
+
+    void XmlOpen(const FlatDocument& document, const FlatSection& section, std::string& out) {
+        out += '<';
+        out += document.Text(section.name);
+        out += ">\n";
+        for (uint32_t i = 0; i < section.variables.count; i++) {
+            const FlatVariable& variable = document.Variables()[section.variables.first + i];
+            XmlValue(document, variable, document.Text(variable.name), out);
+        }
+    }
+
+    void Xml(const FlatDocument& document, const FlatSection& root, std::string& out) {
+        XmlOpen(document, root, out);
+        std::vector<OpenSection> stack{{&root, 0, false}};
+        while (!stack.empty()) {
+            OpenSection& top = stack.back();
+            if (top.next == top.section->children.count) {
+                out += "</";
+                out += document.Text(top.section->name);
+                out += ">\n";
+                stack.pop_back();
+                continue;
+            }
+            const FlatSection& child = document.Sections()[top.section->children.first + top.next++];
+            XmlOpen(document, child, out);
+            stack.push_back({&child, 0, false});
+        }
+    }
 
-int main() {
-    std::string data = R"(
+    void JsonValue(const FlatDocument& document, const FlatVariable& variable, std::string& out) {
+        if (variable.type != ARRAY) {
+            AppendScalar(out, document, variable, JSON);
+            return;
+        }
+        out += '[';
+        std::vector<OpenArray> stack{{&variable, 0}};
+        while (!stack.empty()) {
+            OpenArray& top = stack.back();
+            if (top.next == top.array->value.count) {
+                out += ']';
+                stack.pop_back();
+                continue;
+            }
+            if (top.next > 0) {
+                out += ',';
+            }
+            const FlatVariable& element = document.Elements()[top.array->value.first + top.next++];
+            if (element.type == ARRAY) {
+                out += '[';
+                stack.push_back({&element, 0});
+            } else {
+                AppendScalar(out, document, element, JSON);
+            }
+        }
+    }
+
+    // Writes '{' and the variables; returns whether nothing was written
+    // after the brace.
+    bool JsonOpen(const FlatDocument& document, const FlatSection& section, std::string& out) {
+        out += '{';
+        for (uint32_t i = 0; i < section.variables.count; i++) {
+            const FlatVariable& variable = document.Variables()[section.variables.first + i];
+            out += i == 0 ? "\"" : ",\"";
+            AppendEscaped(out, document.Text(variable.name), JSON);
+            out += "\":";
+            JsonValue(document, variable, out);
+        }
+        return section.variables.count == 0;
+    }
+
+    void Json(const FlatDocument& document, const FlatSection& root, std::string& out) {
+        std::vector<OpenSection> stack{{&root, 0, JsonOpen(document, root, out)}};
+        while (!stack.empty()) {
+            OpenSection& top = stack.back();
+            if (top.next == top.section->children.count) {
+                out += '}';
+                stack.pop_back();
+                continue;
+            }
+            const FlatSection& child = document.Sections()[top.section->children.first + top.next++];
+            out += top.empty ? "\"" : ",\"";
+            top.empty = false;
+            AppendEscaped(out, document.Text(child.name), JSON);
+            out += "\":";
+            stack.push_back({&child, 0, JsonOpen(document, child, out)});
+        }
+    }
+
+    void Serialize(const Parser& parser, FORMAT format, std::string& out) {
+        FlatDocument document = Flatten(parser);
+        if (format == XML) {
+            Xml(document, document.Root(), out);
+        } else {
+            Json(document, document.Root(), out);
+            out += '\n';
+        }
+    }
+
+    bool WriteFile(const std::filesystem::path& path, const std::string& data) {
+        std::FILE* file = std::fopen(path.string().c_str(), "wb");
+        if (file == nullptr) {
+            return false;
+        }
+        // The whole document is already in one buffer, so stdio buffering
+        // would only add a copy.
+        std::setvbuf(file, nullptr, _IONBF, 0);
+        bool written = std::fwrite(data.data(), 1, data.size(), file) == data.size();
+        return std::fclose(file) == 0 && written;
+    }
+
+    // Fails, after reporting every clash, when two inputs would be written
+    // to the same output, e.g. files with the same name from different
+    // directories under -o.
+    bool CollectJobs(const Options& options, std::vector<Job>& jobs) {
+        const char* extension = options.format == XML ? ".xml" : ".json";
+        std::map<std::filesystem::path, std::filesystem::path> inputs_by_output;
+        bool unique = true;
+        auto add = [&](const std::filesystem::path& input, const std::filesystem::path& relative) {
+            std::filesystem::path output = options.output_dir.empty() ? input : options.output_dir / relative;
+            output.replace_extension(extension);
+            auto [it, inserted] = inputs_by_output.emplace(output.lexically_normal(), input);
+            if (!inserted) {
+                std::cerr << input.string() << ": output " << output.string() << " is also written for "
+                          << it->second.string() << '\n';
+                unique = false;
+                return;
+            }
+            jobs.push_back({input, output});
+        };
+        for (const std::filesystem::path& input : options.inputs) {
+            if (!std::filesystem::is_directory(input)) {
+                add(input, input.filename());
+                continue;
+            }
+            for (const auto& entry : std::filesystem::recursive_directory_iterator(input)) {
+                if (entry.is_regular_file() && entry.path().extension() == ".omfl") {
+                    add(entry.path(), std::filesystem::relative(entry.path(), input));
+                }
+            }
+        }
+        return unique;
+    }
+
+    // Workers take the next job from a shared counter and keep their parser
+    // context and output buffer for every file they convert.
+    Stats Convert(const std::vector<Job>& jobs, const Options& options) {
+        std::atomic<size_t> next{0};
+        std::mutex report_mutex;
+        std::vector<Stats> stats(options.threads);
+        auto work = [&](Stats& local) {
+            ParserContext context;
+            std::string out;
+            for (size_t i = next++; i < jobs.size(); i = next++) {
+                const Job& job = jobs[i];
+                InputFile input;
+                std::string error;
+                if (!input.Open(job.input, options.map_input)) {
+                    error = "cannot read input";
+                } else {
+                    Parser parser = context.Parse(input.View());
+                    local.bytes_in += input.View().size();
+                    if (!parser.valid()) {
+                        const Diagnostic& diagnostic = parser.GetDiagnostics().front();
+                        error = "invalid at " + std::to_string(diagnostic.line) + ':' +
+                                std::to_string(diagnostic.column);
+                    } else {
+                        out.clear();
+                        Serialize(parser, options.format, out);
+                        if (!options.output_dir.empty()) {
+                            std::error_code ignored;
+                            std::filesystem::create_directories(job.output.parent_path(), ignored);
+                        }
+                        if (!WriteFile(job.output, out)) {
+                            error = "cannot write " + job.output.string();
+                        }
+                        local.bytes_out += out.size();
+                    }
+                }
+                if (error.empty()) {
+                    local.converted++;
+                } else {
+                    local.failed++;
+                    std::lock_guard<std::mutex> lock(report_mutex);
+                    std::cerr << job.input.string() << ": " << error << '\n';
+                }
+            }
+        };
+        std::vector<std::thread> threads;
+        for (size_t i = 1; i < options.threads; i++) {
+            threads.emplace_back(work, std::ref(stats[i]));
+        }
+        work(stats[0]);
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+        Stats total;
+        for (const Stats& local : stats) {
+            total.converted += local.converted;
+            total.failed += local.failed;
+            total.bytes_in += local.bytes_in;
+            total.bytes_out += local.bytes_out;
+        }
+        return total;
+    }
+
+    void PrintUsage() {
+        std::cerr << "usage: lab6 [-j threads] [-f xml|json] [-o output_dir] [--no-mmap] input...\n"
+                     "Converts OMFL files, and every *.omfl file under input directories, next to\n"
+                     "the input or under output_dir. Without inputs prints the built-in example.\n";
+    }
+
+    bool ParseArguments(int argc, char** argv, Options& options) {
+        for (int i = 1; i < argc; i++) {
+            std::string_view argument = argv[i];
+            bool has_value = i + 1 < argc;
+            if (argument == "-j" && has_value) {
+                std::string_view value = argv[++i];
+                auto result = std::from_chars(value.data(), value.data() + value.size(), options.threads);
+                if (result.ec != std::errc() || result.ptr != value.data() + value.size() || options.threads == 0) {
+                    return false;
+                }
+            } else if (argument == "-f" && has_value) {
+                std::string_view value = argv[++i];
+                if (value != "xml" && value != "json") {
+                    return false;
+                }
+                options.format = value == "xml" ? XML : JSON;
+            } else if (argument == "-o" && has_value) {
+                options.output_dir = argv[++i];
+            } else if (argument == "--no-mmap") {
+                options.map_input = false;
+            } else if (!argument.empty() && argument.front() == '-') {
+                return false;
+            } else {
+                options.inputs.emplace_back(argument);
+            }
+        }
+        return true;
+    }
+
+}// namespace
+
+OMFL_EMBED(kDefaultConfig, R"(
     [common]
     name = "Common config"
     description = "Some config"
@@ -41,12 +458,38 @@ int main() {
     [servers.second]
     enabled = true
     ip = "127.0.0.1"
-        )";
-    Parser parser = parse(data);
-    std::string path = "C:\\Users\\Home\\Documents\\labs\\labwork-6-dubstephf\\123.xml";
-    parser.SetPath(path);
-    Section* current_section = &parser.Global();
-    std::fstream file(parser.GetPath());
-    XML(current_section, file);
-    return 0;
+        )");
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!ParseArguments(argc, argv, options)) {
+        PrintUsage();
+        return 2;
+    }
+    if (options.inputs.empty()) {
+        Parser parser = Materialize(kDefaultConfig);
+        std::string out;
+        Serialize(parser, options.format, out);
+        std::cout << out;
+        return 0;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<Job> jobs;
+    if (!CollectJobs(options, jobs)) {
+        return 1;
+    }
+    options.threads = std::max<size_t>(1, std::min(options.threads, jobs.size()));
+    Stats stats = Convert(jobs, options);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    double megabytes_in = stats.bytes_in / 1e6;
+    std::fprintf(stderr,
+                 "%zu converted, %zu failed, %zu threads\n"
+                 "%.2f MB in, %.2f MB out in %.3f s: %.1f MB/s, %.0f files/s\n",
+                 stats.converted, stats.failed, options.threads,
+                 megabytes_in, stats.bytes_out / 1e6, seconds,
+                 seconds > 0 ? megabytes_in / seconds : 0.0,
+                 seconds > 0 ? (stats.converted + stats.failed) / seconds : 0.0);
+    return stats.failed == 0 ? 0 : 1;
 }
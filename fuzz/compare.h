@@ -0,0 +1,93 @@
+#pragma once
+
+#include "lib/parser.h"
+
+#include <cstring>
+
+namespace omfl::fuzz {
+
+    // Structural equality of two documents: validity, diagnostics, and the
+    // section tree with every variable compared by name, type and value in
+    // declaration order. On mismatch `where` names the first differing node.
+    inline bool SameVariable(Variable& left, Variable& right, const std::string& path, std::string& where) {
+        if (left.GetName() != right.GetName() || left.IsInt() != right.IsInt() ||
+            left.IsString() != right.IsString() || left.IsBool() != right.IsBool() ||
+            left.IsFloat() != right.IsFloat() || left.IsArray() != right.IsArray()) {
+            where = path + left.GetName();
+            return false;
+        }
+        bool same = true;
+        if (left.IsInt()) {
+            same = left.AsInt() == right.AsInt();
+        } else if (left.IsString()) {
+            same = left.AsString() == right.AsString();
+        } else if (left.IsBool()) {
+            same = left.AsBool() == right.AsBool();
+        } else if (left.IsFloat()) {
+            float a = left.AsFloat();
+            float b = right.AsFloat();
+            same = std::memcmp(&a, &b, sizeof(float)) == 0;
+        } else if (left.IsArray()) {
+            Array& a = dynamic_cast<Array&> (left);
+            Array& b = dynamic_cast<Array&> (right);
+            same = a.Size() == b.Size();
+            for (size_t i = 0; same && i < a.Size(); i++) {
+                if (!SameVariable(a[i], b[i], path + left.GetName() + "[" + std::to_string(i) + "].", where)) {
+                    return false;
+                }
+            }
+        }
+        if (!same) {
+            where = path + left.GetName();
+        }
+        return same;
+    }
+
+    inline bool SameSection(Section& left, Section& right, const std::string& path, std::string& where) {
+        std::vector<Variable*>& left_vars = left.GetArr();
+        std::vector<Variable*>& right_vars = right.GetArr();
+        std::vector<Section*>& left_children = left.GetSectionChild();
+        std::vector<Section*>& right_children = right.GetSectionChild();
+        if (left_vars.size() != right_vars.size() || left_children.size() != right_children.size()) {
+            where = path.empty() ? "<global>" : path;
+            return false;
+        }
+        for (size_t i = 0; i < left_vars.size(); i++) {
+            if (!SameVariable(*left_vars[i], *right_vars[i], path, where)) {
+                return false;
+            }
+        }
+        for (size_t i = 0; i < left_children.size(); i++) {
+            if (left_children[i]->GetName() != right_children[i]->GetName()) {
+                where = path + left_children[i]->GetName();
+                return false;
+            }
+            if (!SameSection(*left_children[i], *right_children[i], path + left_children[i]->GetName() + ".",
+                             where)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    inline bool SameDocument(Parser& left, Parser& right, std::string& where) {
+        if (left.valid() != right.valid()) {
+            where = "valid()";
+            return false;
+        }
+        const std::vector<Diagnostic>& a = left.GetDiagnostics();
+        const std::vector<Diagnostic>& b = right.GetDiagnostics();
+        if (a.size() != b.size()) {
+            where = "diagnostics";
+            return false;
+        }
+        for (size_t i = 0; i < a.size(); i++) {
+            if (a[i].offset != b[i].offset || a[i].line != b[i].line || a[i].column != b[i].column ||
+                a[i].kind != b[i].kind) {
+                where = "diagnostic #" + std::to_string(i);
+                return false;
+            }
+        }
+        return SameSection(left.Global(), right.Global(), "", where);
+    }
+}// namespace
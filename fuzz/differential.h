@@ -0,0 +1,50 @@
+#pragma once
+
+#include "fuzz/compare.h"
+#include "fuzz/reference.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+
+namespace omfl::fuzz {
+
+    // A candidate parse engine: must produce the same document as omfl::parse
+    // for every input, including invalid ones, and agree with the frozen
+    // reference parser wherever DeliberateChange() does not excuse it.
+    using Engine = std::function<Parser(const std::string&)>;
+
+    // Runs omfl::parse and `engine` on the same input, and aborts with the
+    // first differing node so that the fuzzer records the input as a crash.
+    // The result is then checked against the reference parser.
+    inline void CheckEngine(const char* name, const Engine& engine, const std::string& input) {
+        Parser expected = parse(input);
+        Parser actual = engine(input);
+        std::string where;
+        if (!SameDocument(expected, actual, where)) {
+            std::fprintf(stderr, "engine '%s' differs from omfl::parse at %s\n", name, where.c_str());
+            std::abort();
+        }
+        CheckReference(name, actual, input);
+    }
+
+    // Serves its data one byte per underflow, so that every streambuf refill
+    // boundary falls at a different place in the input.
+    class TrickleBuffer : public std::streambuf {
+        std::string data_;
+        size_t position_ = 0;
+
+    protected:
+        int_type underflow() override {
+            if (position_ >= data_.size()) {
+                return traits_type::eof();
+            }
+            char* current = &data_[position_++];
+            setg(current, current, current + 1);
+            return traits_type::to_int_type(*current);
+        }
+
+    public:
+        explicit TrickleBuffer(std::string data) : data_(std::move(data)) {}
+    };
+}// namespace
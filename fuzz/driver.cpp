@@ -0,0 +1,40 @@
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+// Replays inputs through a fuzz target when libFuzzer is not available:
+// every argument is a file or a directory of files (e.g. a saved corpus).
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size);
+
+namespace {
+
+    void Run(const std::filesystem::path& path) {
+        std::ifstream file(path, std::ios::binary);
+        std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        LLVMFuzzerTestOneInput(reinterpret_cast<const uint8_t*>(data.data()), data.size());
+    }
+
+}// namespace
+
+int main(int argc, char** argv) {
+    size_t runs = 0;
+    for (int i = 1; i < argc; i++) {
+        if (std::filesystem::is_directory(argv[i])) {
+            for (const auto& entry : std::filesystem::recursive_directory_iterator(argv[i])) {
+                if (entry.is_regular_file()) {
+                    Run(entry.path());
+                    runs++;
+                }
+            }
+        } else {
+            Run(argv[i]);
+            runs++;
+        }
+    }
+    std::printf("executed %zu inputs\n", runs);
+    return 0;
+}
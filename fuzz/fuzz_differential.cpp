@@ -0,0 +1,31 @@
+#include "fuzz/differential.h"
+
+#include <cstddef>
+#include <cstdint>
+
+using namespace omfl;
+
+namespace {
+
+    ParserContext context;
+
+}// namespace
+
+// Every parse path is checked against omfl::parse and the reference parser
+// here. New engines are added to this list before they are used in
+// production.
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    std::string input(reinterpret_cast<const char*>(data), size);
+    fuzz::CheckEngine("parse", [](const std::string& text) {
+        return parse(text);
+    }, input);
+    fuzz::CheckEngine("context", [](const std::string& text) {
+        return context.Parse(text);
+    }, input);
+    fuzz::CheckEngine("istream", [](const std::string& text) {
+        fuzz::TrickleBuffer buffer(text);
+        std::istream stream(&buffer);
+        return parse(stream);
+    }, input);
+    return 0;
+}
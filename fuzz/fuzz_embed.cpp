@@ -0,0 +1,41 @@
+#include "fuzz/compare.h"
+#include "lib/embed.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+using namespace omfl;
+
+namespace {
+
+    const size_t kCapacity = 256;
+
+}// namespace
+
+// Embed() repeats the rules of parse() in constexpr code. Both must accept
+// the same inputs, and Materialize() must rebuild the document parse()
+// returns.
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    std::string input(reinterpret_cast<const char*>(data), size);
+    if (embed::CountEntries(input) > kCapacity) {
+        return 0;
+    }
+    EmbeddedConfig<kCapacity> config = Embed<kCapacity>(input);
+    Parser expected = parse(input);
+    if (config.valid != expected.valid()) {
+        std::fprintf(stderr, "Embed %s what parse %s\n", config.valid ? "accepts" : "rejects",
+                     expected.valid() ? "accepts" : "rejects");
+        std::abort();
+    }
+    if (config.valid) {
+        Parser actual = Materialize(config);
+        std::string where;
+        if (!fuzz::SameDocument(expected, actual, where)) {
+            std::fprintf(stderr, "Materialize differs from parse at %s\n", where.c_str());
+            std::abort();
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,19 @@
+#include "lib/parser.h"
+
+#include <cstddef>
+#include <cstdint>
+
+using namespace omfl;
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    Parser parser = parse(std::string(reinterpret_cast<const char*>(data), size));
+    if (parser.valid() != parser.GetDiagnostics().empty()) {
+        __builtin_trap();
+    }
+    for (const Diagnostic& diagnostic : parser.GetDiagnostics()) {
+        if (diagnostic.offset > size || diagnostic.line == 0 || diagnostic.column == 0) {
+            __builtin_trap();
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,40 @@
+#include "fuzz/compare.h"
+#include "fuzz/reference.h"
+
+#include <cstddef>
+#include <cstdint>
+
+using namespace omfl;
+
+// Builds the same array literal in one piece through ParseArray and in
+// chunks of 1, 2, 3, ... bytes through ArrayBuilder, so that chunk boundaries
+// land inside tokens, strings and comments. Both must agree on success and
+// contents, and with the reference parser on arrays in the form it reads.
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    std::string_view input(reinterpret_cast<const char*>(data), size);
+    Array* whole = ParseArray(input);
+
+    ArrayBuilder builder;
+    builder.Reset();
+    size_t used = 0;
+    size_t chunk = 1;
+    while (used < input.size() && !builder.Failed() && !builder.Done()) {
+        size_t fed = builder.Feed(input.substr(used, chunk));
+        used += fed;
+        if (fed == chunk) {
+            chunk = chunk % 7 + 1;
+        }
+    }
+    Array* trickled = used == input.size() && builder.Done() ? builder.Release() : nullptr;
+
+    if ((whole == nullptr) != (trickled == nullptr)) {
+        __builtin_trap();
+    }
+    std::string where;
+    if (whole != nullptr && !fuzz::SameVariable(*whole, *trickled, "", where)) {
+        __builtin_trap();
+    }
+    fuzz::CheckReferenceArray("ParseArray", whole, input);
+    fuzz::CheckReferenceArray("ArrayBuilder", trickled, input);
+    return 0;
+}
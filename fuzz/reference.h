@@ -0,0 +1,284 @@
+#pragma once
+
+#include "fuzz/reference_parser.h"
+#include "lib/parser.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <set>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace omfl::fuzz {
+
+    // Comparison of a document or array against the reference parser. The
+    // reference has no diagnostics and stops at the first error, so invalid
+    // documents only have to agree on valid().
+    inline bool SameAsReference(reference::Variable& expected, Variable& actual, const std::string& path,
+                                std::string& where) {
+        where = path;
+        if (expected.IsInt() != actual.IsInt() || expected.IsString() != actual.IsString() ||
+            expected.IsBool() != actual.IsBool() || expected.IsFloat() != actual.IsFloat() ||
+            expected.IsArray() != actual.IsArray()) {
+            return false;
+        }
+        if (expected.IsInt()) {
+            return expected.AsInt() == actual.AsInt();
+        } else if (expected.IsString()) {
+            return expected.AsString() == actual.AsString();
+        } else if (expected.IsBool()) {
+            return expected.AsBool() == actual.AsBool();
+        } else if (expected.IsFloat()) {
+            float a = expected.AsFloat();
+            float b = actual.AsFloat();
+            return std::memcmp(&a, &b, sizeof(float)) == 0;
+        }
+        reference::Array& a = dynamic_cast<reference::Array&> (expected);
+        Array& b = dynamic_cast<Array&> (actual);
+        if (a.Size() != b.Size()) {
+            return false;
+        }
+        for (size_t i = 0; i < a.Size(); i++) {
+            if (!SameAsReference(a[static_cast<int>(i)], b[static_cast<int>(i)], path + "[" + std::to_string(i) + "]",
+                                 where)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    inline bool SameAsReference(reference::Section& expected, Section& actual, const std::string& path,
+                                std::string& where) {
+        std::vector<reference::Variable*>& expected_vars = expected.GetArr();
+        std::vector<Variable*>& actual_vars = actual.GetArr();
+        std::vector<reference::Section*>& expected_children = expected.GetSectionChild();
+        std::vector<Section*>& actual_children = actual.GetSectionChild();
+        if (expected_vars.size() != actual_vars.size() || expected_children.size() != actual_children.size()) {
+            where = path.empty() ? "<global>" : path;
+            return false;
+        }
+        for (size_t i = 0; i < expected_vars.size(); i++) {
+            std::string name = expected_vars[i]->GetName();
+            if (name != actual_vars[i]->GetName()) {
+                where = path + name;
+                return false;
+            }
+            if (!SameAsReference(*expected_vars[i], *actual_vars[i], path + name, where)) {
+                return false;
+            }
+        }
+        for (size_t i = 0; i < expected_children.size(); i++) {
+            std::string name = expected_children[i]->GetName();
+            if (name != actual_children[i]->GetName()) {
+                where = path + name;
+                return false;
+            }
+            if (!SameAsReference(*expected_children[i], *actual_children[i], path + name + ".", where)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    inline bool SameAsReference(reference::Parser& expected, Parser& actual, std::string& where) {
+        if (expected.valid() != actual.valid()) {
+            where = "valid()";
+            return false;
+        }
+        return !expected.valid() || SameAsReference(expected.Global(), actual.Global(), "", where);
+    }
+
+    // Whether the array at text[index] is written the one way on which the
+    // reference and ArrayBuilder agree: "[]" or "[a, b, ...]" with exactly one
+    // space after each comma, elements that are valid scalars or arrays of
+    // the same form, and strings free of escapes, brackets and '#'. The
+    // reference skips the character after a comma instead of trimming, and
+    // drops empty and malformed elements instead of rejecting the array.
+    inline bool CanonicalArray(std::string_view text, size_t& index, size_t depth = 0) {
+        if (index >= text.size() || text[index] != '[' || depth > 64) {
+            return false;
+        }
+        index++;
+        if (index < text.size() && text[index] == ']') {
+            index++;
+            return true;
+        }
+        while (index < text.size()) {
+            if (text[index] == '[') {
+                if (!CanonicalArray(text, index, depth + 1)) {
+                    return false;
+                }
+            } else if (text[index] == '\"') {
+                size_t close = text.find('\"', index + 1);
+                if (close == std::string_view::npos) {
+                    return false;
+                }
+                for (size_t i = index + 1; i < close; i++) {
+                    unsigned char c = static_cast<unsigned char>(text[i]);
+                    if (c == '\\' || c == '[' || c == ']' || c == '#' || c == ';' || c < 0x20 || c >= 0x80) {
+                        return false;
+                    }
+                }
+                index = close + 1;
+            } else {
+                size_t end = text.find_first_of(",]", index);
+                if (end == std::string_view::npos) {
+                    return false;
+                }
+                std::string_view token = text.substr(index, end - index);
+                if (token != "true" && token != "false") {
+                    std::string_view digits = token;
+                    if (!digits.empty() && (digits.front() == '+' || digits.front() == '-')) {
+                        digits.remove_prefix(1);
+                    }
+                    size_t dot = digits.find('.');
+                    if (digits.empty() || dot == 0 || dot + 1 == digits.size() ||
+                        digits.find_first_not_of("0123456789.") != std::string_view::npos ||
+                        (dot != std::string_view::npos && digits.find('.', dot + 1) != std::string_view::npos)) {
+                        return false;
+                    }
+                }
+                index = end;
+            }
+            if (index < text.size() && text[index] == ']') {
+                index++;
+                return true;
+            }
+            if (index + 2 >= text.size() || text[index] != ',' || text[index + 1] != ' ' || text[index + 2] == ' ') {
+                return false;
+            }
+            index += 2;
+        }
+        return false;
+    }
+
+    // The documented departures of omfl::parse from the reference parser.
+    // Returns the first one that `input` runs into, or nullptr when the two
+    // must give the same document. Besides these, error recovery means that
+    // invalid documents are only compared on valid(), and inputs on which the
+    // reference throws (number overflow, the guards in reference_parser.cpp)
+    // are not compared at all.
+    inline const char* DeliberateChange(std::string_view input) {
+        if (input.find('\0') != std::string_view::npos) {
+            // The reference ends a value at the first NUL byte.
+            return "NUL bytes";
+        }
+        std::map<std::string, std::string> parent_of;
+        std::set<std::pair<std::string, std::string>> keys;
+        std::string section;
+        size_t start = 0;
+        while (start <= input.size()) {
+            size_t end = std::min(input.find('\n', start), input.size());
+            std::string_view line = input.substr(start, end - start);
+            start = end + 1;
+            size_t first = line.find_first_not_of(" \t");
+            if (first == std::string_view::npos) {
+                continue;
+            }
+            line = line.substr(first, line.find_last_not_of(" \t") + 1 - first);
+            size_t equals = line.find('=');
+            if (equals == std::string_view::npos) {
+                if (line.front() != '[' || line.back() != ']') {
+                    continue;
+                }
+                // Headers are resolved by path now; the reference looked up
+                // every segment by name among all sections, with the root
+                // named "global".
+                section = std::string(line.substr(1, line.size() - 2));
+                std::string path;
+                size_t segment = 0;
+                while (segment <= section.size()) {
+                    size_t dot = std::min(section.find('.', segment), section.size());
+                    std::string name = section.substr(segment, dot - segment);
+                    auto [it, inserted] = parent_of.emplace(name, path);
+                    if (name == "global" || (!inserted && it->second != path)) {
+                        return "section resolution";
+                    }
+                    path += (path.empty() ? "" : ".") + name;
+                    segment = dot + 1;
+                }
+                continue;
+            }
+            if (line.front() == '#') {
+                continue;
+            }
+            std::string_view name = line.substr(0, equals);
+            if (name.find('\t') != std::string_view::npos) {
+                // The reference keeps a tab before '=' as part of the name.
+                return "tabs before '='";
+            }
+            name = name.substr(0, name.find_last_not_of(' ') + 1);
+            std::string_view value = line.substr(equals + 1);
+            if (value.find('\\') != std::string_view::npos ||
+                std::any_of(value.begin(), value.end(), [](char c) { return static_cast<unsigned char>(c) >= 0x80; })) {
+                return "string escapes and UTF-8 validation";
+            }
+            size_t comment = value.find('#');
+            if (comment != std::string_view::npos && value.substr(0, comment).find('\"') != std::string_view::npos) {
+                // The reference cuts every line at its first '#'.
+                return "'#' inside values";
+            }
+            value = value.substr(0, comment);
+            size_t value_first = value.find_first_not_of(" \t");
+            value = value_first == std::string_view::npos ? std::string_view() : value.substr(value_first);
+            value = value.substr(0, value.find_last_not_of(" \t") + 1);
+            if (!value.empty() && value.front() == '[') {
+                size_t index = 0;
+                if (!CanonicalArray(value, index) || index != value.size()) {
+                    return "array syntax";
+                }
+            }
+            if (!keys.emplace(section, std::string(name)).second) {
+                // The reference only rejected duplicate INT keys.
+                return "duplicate keys";
+            }
+        }
+        return nullptr;
+    }
+
+    // Runs the reference parser on `input` and aborts, so that the fuzzer
+    // records a crash, when `actual` differs from it for a reason that is not
+    // on the DeliberateChange list.
+    inline void CheckReference(const char* name, Parser& actual, const std::string& input) {
+        std::string where;
+        bool same;
+        try {
+            reference::Parser expected = reference::parse(input);
+            same = SameAsReference(expected, actual, where);
+        } catch (const std::exception&) {
+            return;
+        }
+        if (!same && DeliberateChange(input) == nullptr) {
+            std::fprintf(stderr, "engine '%s' differs from the reference parser at %s\n", name, where.c_str());
+            std::abort();
+        }
+    }
+
+    // The same for an array literal given on its own, as ParseArray and
+    // ArrayBuilder take it; `actual` is nullptr for a rejected array.
+    inline void CheckReferenceArray(const char* name, Array* actual, std::string_view input) {
+        std::string text(input);
+        reference::Array* expected = nullptr;
+        try {
+            if (!text.empty() && reference::TypeVar(text) == reference::ARRAY && reference::CheckVarValue(text)) {
+                expected = reference::ParseArray(text, nullptr);
+            }
+        } catch (const std::exception&) {
+            return;
+        }
+        size_t index = 0;
+        if (!CanonicalArray(input, index) || index != input.size()) {
+            return;
+        }
+        std::string where = "<array>";
+        if ((expected == nullptr) != (actual == nullptr) ||
+            (expected != nullptr && !SameAsReference(*expected, *actual, "", where))) {
+            std::fprintf(stderr, "engine '%s' differs from the reference parser at %s\n", name, where.c_str());
+            std::abort();
+        }
+    }
+}// namespace
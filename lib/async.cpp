@@ -0,0 +1,120 @@
+#include "async.h"
+
+#include <fstream>
+
+using namespace omfl;
+
+AsyncLoader::AsyncLoader(size_t parse_threads, size_t max_in_flight)
+    : max_in_flight_(std::max<size_t>(1, max_in_flight)) {
+    if (parse_threads == 0) {
+        parse_threads = std::max<size_t>(1, std::thread::hardware_concurrency());
+    }
+    reader_ = std::thread(&AsyncLoader::ReadLoop, this);
+    for (size_t i = 0; i < parse_threads; i++) {
+        parsers_.emplace_back(&AsyncLoader::ParseLoop, this);
+    }
+}
+
+AsyncLoader::~AsyncLoader() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    read_ready_.notify_all();
+    reader_.join();
+    for (std::thread& parser : parsers_) {
+        parser.join();
+    }
+}
+
+std::future<Parser> AsyncLoader::AsyncParse(const std::filesystem::path& path) {
+    Job job;
+    job.path = path;
+    std::future<Parser> result = job.promise.get_future();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pending_reads_.push_back(std::move(job));
+    }
+    read_ready_.notify_one();
+    return result;
+}
+
+void AsyncLoader::ReadLoop() {
+    while (true) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            read_ready_.wait(lock, [this] { return !pending_reads_.empty() || stopping_; });
+            if (pending_reads_.empty()) {
+                reader_done_ = true;
+                break;
+            }
+            slot_free_.wait(lock, [this] { return in_flight_ < max_in_flight_; });
+            job = std::move(pending_reads_.front());
+            pending_reads_.pop_front();
+            in_flight_++;
+        }
+        std::ifstream file(job.path, std::ios::in | std::ios::binary);
+        if (file) {
+            file.seekg(0, std::ios::end);
+            std::streamoff size = file.tellg();
+            file.seekg(0, std::ios::beg);
+            if (size > 0) {
+                try {
+                    job.data.resize(static_cast<size_t>(size));
+                    file.read(job.data.data(), size);
+                } catch (const std::exception&) {
+                    file.setstate(std::ios::failbit);
+                }
+            }
+            // A failed size query, e.g. on a directory, or a short read is
+            // reported as unreadable rather than parsing a zero-filled tail.
+            job.opened = static_cast<bool>(file);
+            if (!job.opened) {
+                job.data.clear();
+            }
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            pending_parses_.push_back(std::move(job));
+        }
+        parse_ready_.notify_one();
+    }
+    parse_ready_.notify_all();
+}
+
+void AsyncLoader::ParseLoop() {
+    while (true) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            parse_ready_.wait(lock, [this] { return !pending_parses_.empty() || reader_done_; });
+            if (pending_parses_.empty()) {
+                return;
+            }
+            job = std::move(pending_parses_.front());
+            pending_parses_.pop_front();
+        }
+        try {
+            if (job.opened) {
+                job.promise.set_value(parse(job.data));
+            } else {
+                Parser parser;
+                parser.AddDiagnostic({0, 0, 0, UNREADABLE_INPUT});
+                job.promise.set_value(parser);
+            }
+        } catch (...) {
+            job.promise.set_exception(std::current_exception());
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            in_flight_--;
+        }
+        slot_free_.notify_one();
+    }
+}
+
+std::future<Parser> omfl::AsyncParse(const std::filesystem::path& path) {
+    static AsyncLoader loader;
+    return loader.AsyncParse(path);
+}
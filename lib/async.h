@@ -0,0 +1,57 @@
+#pragma once
+
+#include "parser.h"
+
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <thread>
+
+namespace omfl {
+
+    // Two-stage load pipeline: a reader thread pulls whole files into memory
+    // while a pool of workers parses the files already read. At most
+    // `max_in_flight` files are held in memory between the two stages, so
+    // the reader stalls instead of running ahead of the parsers.
+    class AsyncLoader {
+        struct Job {
+            std::filesystem::path path;
+            std::string data;
+            bool opened = false;
+            std::promise<Parser> promise;
+        };
+
+        std::mutex mutex_;
+        std::condition_variable read_ready_;
+        std::condition_variable parse_ready_;
+        std::condition_variable slot_free_;
+        std::deque<Job> pending_reads_;
+        std::deque<Job> pending_parses_;
+        size_t in_flight_ = 0;
+        size_t max_in_flight_;
+        bool stopping_ = false;
+        bool reader_done_ = false;
+        std::thread reader_;
+        std::vector<std::thread> parsers_;
+
+        void ReadLoop();
+
+        void ParseLoop();
+
+    public:
+        explicit AsyncLoader(size_t parse_threads = 0, size_t max_in_flight = 16);
+
+        AsyncLoader(const AsyncLoader&) = delete;
+
+        AsyncLoader& operator=(const AsyncLoader&) = delete;
+
+        // Finishes every file already submitted before joining the threads.
+        ~AsyncLoader();
+
+        std::future<Parser> AsyncParse(const std::filesystem::path& path);
+    };
+
+    // Submits to a process-wide loader with default limits.
+    std::future<Parser> AsyncParse(const std::filesystem::path& path);
+}// namespace
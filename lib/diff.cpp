@@ -0,0 +1,79 @@
+#include "diff.h"
+
+using namespace omfl;
+
+namespace {
+
+    using HashCache = std::unordered_map<const Section*, Hash128>;
+
+    // Section hashes are combined from the maintained LocalHash of every
+    // section on demand, since sections may be shared between documents and
+    // cannot keep a cached subtree hash up to date themselves.
+    Hash128 SubtreeHash(const Section& section, HashCache& cache) {
+        auto it = cache.find(&section);
+        if (it != cache.end()) {
+            return it->second;
+        }
+        Hash128 hash = section.LocalHash();
+        for (const Section* child : section.GetSectionChild()) {
+            hash += HashSectionEntry(child->GetName(), SubtreeHash(*child, cache));
+        }
+        cache.emplace(&section, hash);
+        return hash;
+    }
+
+    std::string Join(const std::string& prefix, const std::string& name) {
+        return prefix.empty() ? name : prefix + '.' + name;
+    }
+
+    void DiffSection(const Section& before, const Section& after, const std::string& path, HashCache& cache,
+                     std::vector<Change>& changes) {
+        if (&before == &after || SubtreeHash(before, cache) == SubtreeHash(after, cache)) {
+            return;
+        }
+        if (before.LocalHash() != after.LocalHash()) {
+            for (Variable* variable : before.GetArr()) {
+                Variable* other = after.FindVar(variable->GetName());
+                if (other == nullptr) {
+                    changes.push_back({REMOVED, Join(path, variable->GetName())});
+                } else if (other != variable && HashVariable(other) != HashVariable(variable)) {
+                    changes.push_back({CHANGED, Join(path, variable->GetName())});
+                }
+            }
+            for (Variable* variable : after.GetArr()) {
+                if (!before.HasVar(variable->GetName())) {
+                    changes.push_back({ADDED, Join(path, variable->GetName())});
+                }
+            }
+        }
+        for (const Section* child : before.GetSectionChild()) {
+            const Section* other = after.FindChild(child->GetName());
+            if (other == nullptr) {
+                changes.push_back({REMOVED, Join(path, child->GetName())});
+            } else {
+                DiffSection(*child, *other, Join(path, child->GetName()), cache, changes);
+            }
+        }
+        for (const Section* child : after.GetSectionChild()) {
+            if (before.FindChild(child->GetName()) == nullptr) {
+                changes.push_back({ADDED, Join(path, child->GetName())});
+            }
+        }
+    }
+}// namespace
+
+Hash128 omfl::Hash(const Section& section) {
+    HashCache cache;
+    return SubtreeHash(section, cache);
+}
+
+Hash128 omfl::Hash(const Parser& parser) {
+    return Hash(parser.Global());
+}
+
+std::vector<Change> omfl::Diff(const Parser& before, const Parser& after) {
+    HashCache cache;
+    std::vector<Change> changes;
+    DiffSection(before.Global(), after.Global(), "", cache, changes);
+    return changes;
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "parser.h"
+
+namespace omfl {
+
+    enum CHANGE {
+        ADDED = 1,
+        REMOVED,
+        CHANGED
+    };
+
+    // A key path that differs between two documents. A section present in
+    // only one of them is reported once by its own path.
+    struct Change {
+        CHANGE kind;
+        std::string path;
+    };
+
+    // Canonical hash of a section and everything below it. It does not depend
+    // on the order of variables or sections, only on their names and values.
+    Hash128 Hash(const Section& section);
+
+    Hash128 Hash(const Parser& parser);
+
+    // Changes turning `before` into `after`, in document order of `before`
+    // followed by additions. Subtrees with equal hashes are skipped.
+    std::vector<Change> Diff(const Parser& before, const Parser& after);
+}// namespace
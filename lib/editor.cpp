@@ -0,0 +1,124 @@
+#include "editor.h"
+
+using namespace omfl;
+
+namespace {
+
+    std::vector<std::string> SplitPath(const std::string& path) {
+        std::vector<std::string> parts;
+        size_t start = 0;
+        while (true) {
+            size_t dot = path.find('.', start);
+            parts.push_back(path.substr(start, dot - start));
+            if (dot == std::string::npos) {
+                return parts;
+            }
+            start = dot + 1;
+        }
+    }
+
+    // Returns a section of the new version that may be modified: a section
+    // already copied during this commit is reused, a shared one is copied and
+    // the copy takes its place among the parent's children.
+    Section* Writable(Section* parent, Section* child, std::unordered_set<Section*>& owned) {
+        if (owned.count(child) != 0) {
+            return child;
+        }
+        Section* copy = new Section(*child);
+        parent->ReplaceChild(child, copy);
+        owned.insert(copy);
+        return copy;
+    }
+
+}// namespace
+
+Editor& Editor::Push(OPERATION operation, const std::string& path, Variable* value) {
+    std::unique_ptr<Element> owned(value);
+    std::vector<std::string> parts = SplitPath(path);
+    for (const std::string& part : parts) {
+        if (!CheckSection(part)) {
+            throw std::invalid_argument("Invalid argument");
+        }
+    }
+    if (operation == SET && !CheckVarName(parts.back())) {
+        throw std::invalid_argument("Invalid argument");
+    }
+    if (value != nullptr) {
+        value->SetName(parts.back());
+    }
+    edits_.push_back({operation, std::move(parts), std::move(owned)});
+    return *this;
+}
+
+Editor& Editor::SetInt(const std::string& path, int value) {
+    return Push(SET, path, new IntVar(value));
+}
+
+Editor& Editor::SetString(const std::string& path, std::string value) {
+    return Push(SET, path, new StringVar(std::move(value)));
+}
+
+Editor& Editor::SetBool(const std::string& path, bool value) {
+    return Push(SET, path, new BoolVar(value));
+}
+
+Editor& Editor::SetFloat(const std::string& path, float value) {
+    return Push(SET, path, new FloatVar(value));
+}
+
+Editor& Editor::SetArray(const std::string& path, const Array& value) {
+    return Push(SET, path, new Array(value));
+}
+
+Editor& Editor::Remove(const std::string& path) {
+    return Push(REMOVE, path, nullptr);
+}
+
+Editor& Editor::InsertSection(const std::string& path) {
+    return Push(INSERT_SECTION, path, nullptr);
+}
+
+void Editor::Clear() {
+    for (Edit& edit : edits_) {
+        if (edit.committed) {
+            static_cast<void>(edit.value.release());
+        }
+    }
+    edits_.clear();
+}
+
+Parser Editor::Commit() const {
+    Parser result(base_);
+    std::unordered_set<Section*> owned = {&result.global_section};
+    for (const Edit& edit : edits_) {
+        size_t depth = edit.operation == INSERT_SECTION ? edit.path.size() : edit.path.size() - 1;
+        Section* section = &result.global_section;
+        bool found = true;
+        for (size_t i = 0; i < depth && found; i++) {
+            Section* child = section->FindChild(edit.path[i]);
+            if (child != nullptr) {
+                section = Writable(section, child, owned);
+            } else if (edit.operation == REMOVE) {
+                found = false;
+            } else {
+                Section* created = new Section(edit.path[i], section);
+                section->SetChild(created);
+                owned.insert(created);
+                section = created;
+            }
+        }
+        if (!found) {
+            continue;
+        }
+        if (edit.operation == SET) {
+            section->SetVar(static_cast<Variable*>(edit.value.get()));
+            edit.committed = true;
+        } else if (edit.operation == REMOVE) {
+            if (!section->RemoveVar(edit.path.back())) {
+                section->RemoveChild(edit.path.back());
+            }
+        }
+    }
+    result.RebuildSectionList();
+    return result;
+}
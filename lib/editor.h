@@ -0,0 +1,72 @@
+#pragma once
+
+#include "parser.h"
+
+#include <memory>
+#include <unordered_set>
+
+namespace omfl {
+
+    // Collects a batch of edits against a parsed document and applies them
+    // into a new version. Sections on the path of an edit are copied, every
+    // other Section, Variable and Array is shared with the base document.
+    class Editor {
+        enum OPERATION {
+            SET = 1,
+            REMOVE,
+            INSERT_SECTION
+        };
+
+        // The editor owns a value until a version that uses it is committed;
+        // from then on the value belongs to that version. Element is the base
+        // with a public destructor.
+        struct Edit {
+            OPERATION operation;
+            std::vector<std::string> path;
+            std::unique_ptr<Element> value;
+            mutable bool committed = false;
+        };
+
+        Parser base_;
+        std::vector<Edit> edits_;
+
+        Editor& Push(OPERATION operation, const std::string& path, Variable* value);
+
+    public:
+        explicit Editor(const Parser& base) : base_(base) {}
+
+        Editor(const Editor&) = delete;
+
+        Editor& operator=(const Editor&) = delete;
+
+        ~Editor() {
+            Clear();
+        }
+
+        // The Set*, Remove and InsertSection methods throw
+        // std::invalid_argument when a segment of the path is not a valid
+        // section or key name.
+
+        Editor& SetInt(const std::string& path, int value);
+
+        Editor& SetString(const std::string& path, std::string value);
+
+        Editor& SetBool(const std::string& path, bool value);
+
+        Editor& SetFloat(const std::string& path, float value);
+
+        Editor& SetArray(const std::string& path, const Array& value);
+
+        Editor& Remove(const std::string& path);
+
+        Editor& InsertSection(const std::string& path);
+
+        [[nodiscard]] size_t Size() const {
+            return edits_.size();
+        }
+
+        void Clear();
+
+        [[nodiscard]] Parser Commit() const;
+    };
+}// namespace
@@ -0,0 +1,41 @@
+#include "embed.h"
+
+using namespace omfl;
+
+Parser omfl::Materialize(const EmbeddedEntry* entries, size_t size) {
+    Parser parser;
+    Section* section = &parser.Global();
+    std::string_view section_path;
+    for (size_t i = 0; i < size; i++) {
+        const EmbeddedEntry& entry = entries[i];
+        if (i == 0 || entry.section != section_path) {
+            section_path = entry.section;
+            section = &parser.Global();
+            std::string_view rest = section_path;
+            while (!rest.empty()) {
+                size_t dot = rest.find('.');
+                std::string name(rest.substr(0, dot));
+                Section* child = section->FindChild(name);
+                section = child != nullptr ? child : &section->SetChild(new Section(name, section));
+                rest = dot == std::string_view::npos ? std::string_view() : rest.substr(dot + 1);
+            }
+        }
+        std::string key(entry.key);
+        if (entry.type == INT) {
+            section->AddNewIntVar(key, static_cast<int>(entry.int_value));
+        } else if (entry.type == STRING) {
+            std::string storage;
+            std::string_view text;
+            DecodeString(entry.text, text, &storage);
+            section->AddNewStringVar(key, std::string(text));
+        } else if (entry.type == BOOL) {
+            section->AddNewBoolVar(key, entry.bool_value);
+        } else if (entry.type == FLOAT) {
+            section->AddNewFloatVar(key, std::stof(std::string(entry.text)));
+        } else if (entry.type == ARRAY) {
+            section->AddNewArray(key, *ParseArray(entry.text));
+        }
+    }
+    parser.RebuildSectionList();
+    return parser;
+}
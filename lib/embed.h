@@ -0,0 +1,444 @@
+#pragma once
+
+#include "parser.h"
+
+#include <array>
+#include <cfloat>
+#include <climits>
+
+namespace omfl {
+
+    // One variable of an embedded document. Strings are views into the
+    // literal without their quotes and with their escapes still encoded,
+    // arrays keep their raw text. A section header is recorded as an
+    // UNDEFINED entry with an empty key. float_value is only computed to
+    // double precision; Materialize reads the float from the text again so
+    // that it rounds exactly as in parse().
+    struct EmbeddedEntry {
+        std::string_view section;
+        std::string_view key;
+        TYPE type = UNDEFINED;
+        std::string_view text;
+        long long int_value = 0;
+        double float_value = 0;
+        bool bool_value = false;
+    };
+
+    template <size_t N>
+    struct EmbeddedConfig {
+        std::string_view source;
+        std::array<EmbeddedEntry, N> entries{};
+        size_t size = 0;
+        bool valid = true;
+        size_t error_line = 0;
+
+        // Exact dotted path, e.g. "servers.first.ip".
+        [[nodiscard]] constexpr const EmbeddedEntry* Find(std::string_view path) const {
+            size_t dot = path.rfind('.');
+            std::string_view section = dot == std::string_view::npos ? std::string_view() : path.substr(0, dot);
+            std::string_view key = dot == std::string_view::npos ? path : path.substr(dot + 1);
+            for (size_t i = 0; i < size; i++) {
+                if (entries[i].section == section && entries[i].key == key) {
+                    return &entries[i];
+                }
+            }
+            return nullptr;
+        }
+    };
+
+    namespace embed {
+
+        constexpr size_t npos = std::string_view::npos;
+
+        constexpr bool IsBlank(char c) {
+            return c == ' ' || c == '\t';
+        }
+
+        constexpr bool IsArrayBlank(char c) {
+            return IsBlank(c) || c == '\r' || c == '\n';
+        }
+
+        constexpr bool IsDigit(char c) {
+            return c >= '0' && c <= '9';
+        }
+
+        constexpr std::string_view Trim(std::string_view text, bool array = false) {
+            while (!text.empty() && (array ? IsArrayBlank(text.front()) : IsBlank(text.front()))) {
+                text.remove_prefix(1);
+            }
+            while (!text.empty() && (array ? IsArrayBlank(text.back()) : IsBlank(text.back()))) {
+                text.remove_suffix(1);
+            }
+            return text;
+        }
+
+        constexpr bool CheckName(std::string_view name) {
+            if (name.empty()) {
+                return false;
+            }
+            for (char c : name) {
+                if (!IsDigit(c) && !(c >= 'a' && c <= 'z') && !(c >= 'A' && c <= 'Z') && c != '-' && c != '_') {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        constexpr bool CheckSection(std::string_view section) {
+            if (section.empty() || section.front() == '.' || section.back() == '.') {
+                return false;
+            }
+            for (size_t i = 0; i < section.size(); i++) {
+                if (section[i] == '[' || section[i] == ']' || (section[i] == '.' && section[i + 1] == '.')) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        // Mirrors DecodeString without producing the decoded text.
+        constexpr bool CheckString(std::string_view body) {
+            size_t i = 0;
+            while (i < body.size()) {
+                char c = body[i];
+                if (c == '\"') {
+                    return false;
+                } else if (c != '\\') {
+                    size_t length = Utf8SequenceLength(body, i);
+                    if (length == 0) {
+                        return false;
+                    }
+                    i += length;
+                    continue;
+                }
+                uint32_t code = 0;
+                size_t length = DecodeEscape(body, i, code);
+                if (length == 0) {
+                    return false;
+                }
+                i += length;
+            }
+            return true;
+        }
+
+        // Compares the unsigned decimal whole.fraction with the number whose
+        // significant digits are `digits`, the first of them worth
+        // 10^exponent. Returns a negative, zero or positive result.
+        constexpr int CompareDecimal(std::string_view whole, std::string_view fraction, std::string_view digits,
+                                     int exponent) {
+            while (!whole.empty() && whole.front() == '0') {
+                whole.remove_prefix(1);
+            }
+            int leading = static_cast<int>(whole.size()) - 1;
+            if (whole.empty()) {
+                size_t zeros = 0;
+                while (zeros < fraction.size() && fraction[zeros] == '0') {
+                    zeros++;
+                }
+                if (zeros == fraction.size()) {
+                    return -1;
+                }
+                fraction.remove_prefix(zeros);
+                leading = -static_cast<int>(zeros) - 1;
+            }
+            if (leading != exponent) {
+                return leading < exponent ? -1 : 1;
+            }
+            size_t size = whole.size() + fraction.size();
+            for (size_t i = 0; i < size || i < digits.size(); i++) {
+                char digit = i >= size ? '0' : i < whole.size() ? whole[i] : fraction[i - whole.size()];
+                char bound = i < digits.size() ? digits[i] : '0';
+                if (digit != bound) {
+                    return digit < bound ? -1 : 1;
+                }
+            }
+            return 0;
+        }
+
+        // std::stof, which reads variables, reports a value as out of range
+        // when it rounds to infinity, i.e. from 2^128 - 2^103 on, or when a
+        // nonzero value rounds to a denormal or zero, i.e. below
+        // 2^-126 - 2^-150. (It still accepts a denormal that is written out
+        // exactly, which takes over a hundred digits; those are rejected
+        // here.) std::from_chars, which reads array elements, accepts
+        // denormals and only rejects what rounds to zero, i.e. up to 2^-150.
+        constexpr std::string_view kFloatOverflow = "340282356779733661637539395458142568448";
+
+        constexpr std::string_view kFloatUnderflow =
+            "11754942807573642917278829910357665133228589927589904276829631184250030649651730385585324256680905818939"
+            "208984375";
+
+        constexpr std::string_view kFloatElementUnderflow =
+            "70064923216240853546186479164495806564013097093825788587853414194489554134293030074331909418106079101562"
+            "5";
+
+        // Mirrors TypeVar/CheckVarValue and the int/float range checks of
+        // parse() for a single scalar value, or for an array element.
+        constexpr bool ParseScalar(std::string_view token, EmbeddedEntry& entry, bool element = false) {
+            if (token.size() >= 2 && token.front() == '\"' && token.back() == '\"') {
+                if (!CheckString(token.substr(1, token.size() - 2))) {
+                    return false;
+                }
+                entry.type = STRING;
+                entry.text = token.substr(1, token.size() - 2);
+                return true;
+            }
+            if (token == "true" || token == "false") {
+                entry.type = BOOL;
+                entry.bool_value = token == "true";
+                return true;
+            }
+            entry.text = token;
+            bool negative = !token.empty() && token.front() == '-';
+            if (!token.empty() && (token.front() == '+' || token.front() == '-')) {
+                token.remove_prefix(1);
+            }
+            size_t dot = token.find('.');
+            std::string_view whole = token.substr(0, dot);
+            std::string_view fraction = dot == npos ? std::string_view() : token.substr(dot + 1);
+            if (whole.empty() || (dot != npos && fraction.empty())) {
+                return false;
+            }
+            // The first 19 significant digits are kept exactly, the rest
+            // only move the decimal exponent.
+            unsigned long long digits = 0;
+            size_t significant = 0;
+            long long exponent = 0;
+            for (size_t i = 0; i < token.size(); i++) {
+                if (i == dot) {
+                    continue;
+                }
+                if (!IsDigit(token[i])) {
+                    return false;
+                }
+                if (significant < 19) {
+                    digits = digits * 10 + (token[i] - '0');
+                    significant += digits != 0;
+                    exponent -= i > dot;
+                } else {
+                    exponent += i < dot;
+                }
+            }
+            if (dot == npos) {
+                if (exponent != 0 || digits > static_cast<unsigned long long>(INT_MAX) + negative) {
+                    return false;
+                }
+                entry.type = INT;
+                entry.int_value = negative ? -static_cast<long long>(digits) : static_cast<long long>(digits);
+                return true;
+            }
+            if (CompareDecimal(whole, fraction, kFloatOverflow, 38) >= 0) {
+                return false;
+            }
+            if (digits != 0 && (element ? CompareDecimal(whole, fraction, kFloatElementUnderflow, -46) <= 0
+                                        : CompareDecimal(whole, fraction, kFloatUnderflow, -38) < 0)) {
+                return false;
+            }
+            double value = static_cast<double>(digits);
+            double scale = 1;
+            for (long long i = exponent < 0 ? -exponent : exponent; i > 0 && scale < 1e300; i--) {
+                scale *= 10;
+            }
+            value = exponent < 0 ? value / scale : value * scale;
+            // Just below the overflow bound the double may round up to it,
+            // and from there the float would round to infinity.
+            if (value > FLT_MAX) {
+                value = FLT_MAX;
+            }
+            entry.type = FLOAT;
+            entry.float_value = negative ? -value : value;
+            return true;
+        }
+
+        // Validates the array literal starting at text[begin] == '[', which
+        // may span several lines, the way ArrayBuilder does. Returns the
+        // index one past its closing bracket, or npos.
+        constexpr size_t ScanArray(std::string_view text, size_t begin) {
+            size_t depth = 0;
+            size_t start = begin + 1;
+            std::string_view pending;
+            bool in_string = false;
+            bool in_escape = false;
+            bool closed_child = false;
+            bool after_comma = false;
+            for (size_t i = begin; i < text.size(); i++) {
+                char c = text[i];
+                if (in_escape) {
+                    in_escape = false;
+                } else if (in_string) {
+                    in_escape = c == '\\';
+                    in_string = c != '\"';
+                } else if (c == '\"') {
+                    in_string = true;
+                } else if (c == '#') {
+                    // A token may continue after a comment only with blanks.
+                    std::string_view part = Trim(text.substr(start, i - start), true);
+                    size_t end = text.find('\n', i);
+                    if (end == npos || (!pending.empty() && !part.empty())) {
+                        return npos;
+                    }
+                    if (!part.empty()) {
+                        pending = part;
+                    }
+                    i = end;
+                    start = end + 1;
+                } else if (c == '[') {
+                    if (depth > 0 && (closed_child || !pending.empty() ||
+                                      !Trim(text.substr(start, i - start), true).empty())) {
+                        return npos;
+                    }
+                    depth++;
+                    closed_child = false;
+                    after_comma = false;
+                    start = i + 1;
+                } else if (c == ',' || c == ']') {
+                    std::string_view token = Trim(text.substr(start, i - start), true);
+                    if (!pending.empty()) {
+                        if (!token.empty()) {
+                            return npos;
+                        }
+                        token = pending;
+                        pending = std::string_view();
+                    }
+                    if (closed_child) {
+                        if (!token.empty()) {
+                            return npos;
+                        }
+                    } else if (token.empty()) {
+                        if (c == ',' || after_comma) {
+                            return npos;
+                        }
+                    } else {
+                        EmbeddedEntry scratch;
+                        if (!ParseScalar(token, scratch, true)) {
+                            return npos;
+                        }
+                    }
+                    start = i + 1;
+                    after_comma = c == ',';
+                    closed_child = c == ']';
+                    if (c == ']' && --depth == 0) {
+                        return i + 1;
+                    }
+                }
+            }
+            return npos;
+        }
+
+        // Every line holds at most one variable or section header.
+        constexpr size_t CountEntries(std::string_view text) {
+            size_t count = 1;
+            for (char c : text) {
+                count += c == '\n';
+            }
+            return count;
+        }
+
+    }// namespace embed
+
+    // Validates and indexes an OMFL literal entirely at compile time, following
+    // the same line rules as parse(). On the first error `valid` is cleared
+    // and `error_line` holds its 1-based line.
+    template <size_t N>
+    constexpr EmbeddedConfig<N> Embed(std::string_view text) {
+        EmbeddedConfig<N> config;
+        config.source = text;
+        std::string_view section;
+        size_t line_number = 0;
+        size_t position = 0;
+        while (position < text.size() && config.valid) {
+            line_number++;
+            size_t end = text.find('\n', position);
+            if (end == embed::npos) {
+                end = text.size();
+            }
+            std::string_view line = embed::Trim(text.substr(position, end - position));
+            size_t line_begin = position;
+            position = end + 1;
+            size_t equals = line.find('=');
+            if (line.empty() || line.front() == '#') {
+                continue;
+            } else if (equals == embed::npos) {
+                if (line.front() == '[' && line.back() == ']') {
+                    line = line.substr(1, line.size() - 2);
+                    if (!embed::CheckSection(line)) {
+                        config.valid = false;
+                    }
+                    section = line;
+                    bool known = false;
+                    for (size_t i = 0; i < config.size && !known; i++) {
+                        known = config.entries[i].section == section;
+                    }
+                    if (config.valid && !known) {
+                        EmbeddedEntry header;
+                        header.section = section;
+                        config.entries[config.size++] = header;
+                    }
+                } else if (line.find('#') == embed::npos) {
+                    config.valid = false;
+                }
+            } else {
+                EmbeddedEntry entry;
+                entry.section = section;
+                entry.key = embed::Trim(line.substr(0, equals));
+                std::string_view value = embed::Trim(line.substr(equals + 1));
+                if (!value.empty() && value.front() == '[' && entry.key.find('#') == embed::npos &&
+                    entry.key.find('[') == embed::npos) {
+                    size_t array_begin = static_cast<size_t>(value.data() - text.data());
+                    size_t array_end = embed::ScanArray(text, array_begin);
+                    if (array_end == embed::npos) {
+                        config.valid = false;
+                        break;
+                    }
+                    for (size_t i = line_begin; i < array_end; i++) {
+                        line_number += text[i] == '\n';
+                    }
+                    size_t tail_end = text.find('\n', array_end);
+                    if (tail_end == embed::npos) {
+                        tail_end = text.size();
+                    }
+                    std::string_view tail = embed::Trim(text.substr(array_end, tail_end - array_end));
+                    config.valid = tail.empty() || tail.front() == '#';
+                    entry.type = ARRAY;
+                    entry.text = text.substr(array_begin, array_end - array_begin);
+                    position = tail_end + 1;
+                } else {
+                    line = line.substr(0, FindComment(line));
+                    equals = line.find('=');
+                    if (equals == embed::npos) {
+                        config.valid = false;
+                        break;
+                    }
+                    entry.key = embed::Trim(line.substr(0, equals));
+                    config.valid = embed::ParseScalar(embed::Trim(line.substr(equals + 1)), entry);
+                }
+                config.valid = config.valid && embed::CheckName(entry.key);
+                for (size_t i = 0; i < config.size && config.valid; i++) {
+                    config.valid = !(config.entries[i].section == section && config.entries[i].key == entry.key);
+                }
+                if (config.valid) {
+                    config.entries[config.size++] = entry;
+                }
+            }
+        }
+        if (!config.valid) {
+            config.error_line = line_number;
+        }
+        return config;
+    }
+
+    // Builds a regular document from the pre-validated entries, without
+    // reading the source text again.
+    Parser Materialize(const EmbeddedEntry* entries, size_t size);
+
+    template <size_t N>
+    Parser Materialize(const EmbeddedConfig<N>& config) {
+        return Materialize(config.entries.data(), config.size);
+    }
+}// namespace
+
+// Declares a constexpr EmbeddedConfig named `name` and fails the build when
+// the literal is not a valid OMFL document.
+#define OMFL_EMBED(name, literal)                                                                  \
+    constexpr auto name = omfl::Embed<omfl::embed::CountEntries(literal)>(literal);                \
+    static_assert(name.valid, "malformed embedded OMFL document " #name)
@@ -0,0 +1,136 @@
+#include "extract.h"
+
+#include <thread>
+
+using namespace omfl;
+
+namespace {
+
+    const size_t kBlockRows = 64;
+
+    struct CompiledPath {
+        std::vector<std::string> sections;
+        std::string key;
+        TYPE type;
+    };
+
+    CompiledPath Compile(const ColumnSpec& spec) {
+        CompiledPath compiled;
+        compiled.type = spec.type;
+        size_t start = 0;
+        size_t dot;
+        while ((dot = spec.path.find('.', start)) != std::string::npos) {
+            compiled.sections.push_back(spec.path.substr(start, dot - start));
+            start = dot + 1;
+        }
+        compiled.key = spec.path.substr(start);
+        return compiled;
+    }
+
+    Variable* Resolve(const CompiledPath& path, const Parser& document) {
+        const Section* section = &document.Global();
+        for (const std::string& name : path.sections) {
+            section = section->FindChild(name);
+            if (section == nullptr) {
+                return nullptr;
+            }
+        }
+        Variable* variable = section->FindVar(path.key);
+        if (variable == nullptr) {
+            return nullptr;
+        }
+        bool matches = (path.type == INT && variable->IsInt()) || (path.type == BOOL && variable->IsBool()) ||
+                       (path.type == FLOAT && variable->IsFloat()) ||
+                       (path.type == STRING && variable->IsString());
+        return matches ? variable : nullptr;
+    }
+
+    // Fills rows [begin, end) of every column. Blocks start on a multiple of
+    // 64 rows, so workers never share a validity word. String bytes go to a
+    // per-worker buffer and the row lengths to offsets[row + 1]; both are
+    // stitched together after all workers finish.
+    void ExtractRows(const std::vector<CompiledPath>& paths, const std::vector<const Parser*>& documents,
+                     size_t begin, size_t end, std::vector<Column>& columns, std::vector<std::string>& strings) {
+        for (size_t row = begin; row < end; row++) {
+            for (size_t i = 0; i < paths.size(); i++) {
+                Column& column = columns[i];
+                Variable* variable = documents[row] != nullptr ? Resolve(paths[i], *documents[row]) : nullptr;
+                if (variable == nullptr) {
+                    continue;
+                }
+                column.validity[row / 64] |= uint64_t(1) << (row % 64);
+                if (column.type == INT) {
+                    column.ints[row] = variable->AsInt();
+                } else if (column.type == BOOL) {
+                    column.ints[row] = variable->AsBool();
+                } else if (column.type == FLOAT) {
+                    column.floats[row] = variable->AsFloat();
+                } else if (column.type == STRING) {
+                    std::string value = variable->AsString();
+                    strings[i] += value;
+                    column.offsets[row + 1] = value.size();
+                }
+            }
+        }
+    }
+
+}// namespace
+
+Table omfl::Extract(const std::vector<ColumnSpec>& paths, const std::vector<const Parser*>& documents,
+                    size_t threads) {
+    Table table;
+    table.rows = documents.size();
+    std::vector<CompiledPath> compiled;
+    for (const ColumnSpec& spec : paths) {
+        compiled.push_back(Compile(spec));
+        Column column;
+        column.path = spec.path;
+        column.type = spec.type;
+        column.validity.assign((table.rows + 63) / 64, 0);
+        if (spec.type == INT || spec.type == BOOL) {
+            column.ints.assign(table.rows, 0);
+        } else if (spec.type == FLOAT) {
+            column.floats.assign(table.rows, 0);
+        } else if (spec.type == STRING) {
+            column.offsets.assign(table.rows + 1, 0);
+        }
+        table.columns.push_back(std::move(column));
+    }
+
+    size_t blocks = (table.rows + kBlockRows - 1) / kBlockRows;
+    if (threads == 0) {
+        threads = std::max<size_t>(1, std::thread::hardware_concurrency());
+    }
+    threads = std::max<size_t>(1, std::min(threads, blocks));
+    size_t blocks_per_thread = (blocks + threads - 1) / threads;
+    std::vector<std::vector<std::string>> strings(threads, std::vector<std::string>(paths.size()));
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < threads; t++) {
+        size_t begin = std::min(table.rows, t * blocks_per_thread * kBlockRows);
+        size_t end = std::min(table.rows, (t + 1) * blocks_per_thread * kBlockRows);
+        if (t + 1 == threads) {
+            ExtractRows(compiled, documents, begin, end, table.columns, strings[t]);
+        } else {
+            workers.emplace_back(ExtractRows, std::cref(compiled), std::cref(documents), begin, end,
+                                 std::ref(table.columns), std::ref(strings[t]));
+        }
+    }
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+
+    for (size_t i = 0; i < table.columns.size(); i++) {
+        Column& column = table.columns[i];
+        if (column.type != STRING) {
+            continue;
+        }
+        for (size_t row = 0; row < table.rows; row++) {
+            column.offsets[row + 1] += column.offsets[row];
+        }
+        column.data.reserve(column.offsets[table.rows]);
+        for (size_t t = 0; t < threads; t++) {
+            column.data += strings[t][i];
+        }
+    }
+    return table;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "parser.h"
+
+#include <cstdint>
+
+namespace omfl {
+
+    struct ColumnSpec {
+        std::string path;
+        TYPE type;
+    };
+
+    // One extracted key path, one row per document. Bit `row` of `validity`
+    // is set when the document defines the path with the requested type.
+    // INT and BOOL values go to `ints`, FLOAT values to `floats`, and the
+    // STRING value of a row is data[offsets[row], offsets[row + 1]).
+    struct Column {
+        std::string path;
+        TYPE type = UNDEFINED;
+        std::vector<uint64_t> validity;
+        std::vector<int64_t> ints;
+        std::vector<double> floats;
+        std::vector<uint64_t> offsets;
+        std::string data;
+
+        [[nodiscard]] bool IsValid(size_t row) const {
+            return (validity[row / 64] >> (row % 64)) & 1;
+        }
+
+        [[nodiscard]] std::string_view StringAt(size_t row) const {
+            return std::string_view(data).substr(offsets[row], offsets[row + 1] - offsets[row]);
+        }
+    };
+
+    struct Table {
+        size_t rows = 0;
+        std::vector<Column> columns;
+    };
+
+    // Resolves every path once, then reads the documents in parallel blocks
+    // of rows. `threads` == 0 uses the hardware concurrency.
+    Table Extract(const std::vector<ColumnSpec>& paths, const std::vector<const Parser*>& documents,
+                  size_t threads = 0);
+}// namespace
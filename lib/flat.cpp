@@ -0,0 +1,113 @@
+#include "flat.h"
+
+using namespace omfl;
+
+FlatRange FlatDocument::AddString(const std::string& value) {
+    FlatRange range{static_cast<uint32_t>(strings_.size()), static_cast<uint32_t>(value.size())};
+    strings_ += value;
+    return range;
+}
+
+void FlatDocument::FillVariable(Variable& source, FlatVariable& target,
+                                std::vector<std::pair<uint32_t, Array*>>& arrays) {
+    target.type = source.IsInt() ? INT : source.IsString() ? STRING : source.IsBool() ? BOOL
+                : source.IsFloat() ? FLOAT : source.IsArray() ? ARRAY : UNDEFINED;
+    if (target.type == INT) {
+        target.int_value = source.AsInt();
+    } else if (target.type == FLOAT) {
+        target.float_value = source.AsFloat();
+    } else if (target.type == BOOL) {
+        target.bool_value = source.AsBool();
+    } else if (target.type == STRING) {
+        target.value = AddString(source.AsString());
+    } else if (target.type == ARRAY) {
+        Array* array = dynamic_cast<Array*> (&source);
+        target.value = {static_cast<uint32_t>(elements_.size()), static_cast<uint32_t>(array->Size())};
+        elements_.resize(elements_.size() + array->Size());
+        arrays.emplace_back(target.value.first, array);
+    }
+}
+
+FlatDocument::FlatDocument(const Parser& parser) {
+    std::vector<const Section*> order = {&parser.Global()};
+    sections_.reserve(parser.GetSectionList().size());
+    sections_.emplace_back();
+    sections_[0].name = AddString(parser.Global().GetName());
+    std::vector<std::pair<uint32_t, Array*>> arrays;
+    for (size_t i = 0; i < order.size(); i++) {
+        const std::vector<Section*>& children = order[i]->GetSectionChild();
+        sections_[i].children = {static_cast<uint32_t>(sections_.size()), static_cast<uint32_t>(children.size())};
+        for (Section* child : children) {
+            FlatSection section;
+            section.name = AddString(child->GetName());
+            section.parent = static_cast<uint32_t>(i);
+            sections_.push_back(section);
+            order.push_back(child);
+        }
+
+        const std::vector<Variable*>& source = order[i]->GetArr();
+        sections_[i].variables = {static_cast<uint32_t>(variables_.size()), static_cast<uint32_t>(source.size())};
+        for (Variable* variable : source) {
+            FlatVariable flat;
+            flat.name = AddString(variable->GetName());
+            FillVariable(*variable, flat, arrays);
+            variables_.push_back(flat);
+        }
+    }
+    // Array items are laid out level by level as well: nested arrays only
+    // reserve their range here and are filled once their turn comes.
+    for (size_t i = 0; i < arrays.size(); i++) {
+        uint32_t first = arrays[i].first;
+        Array* array = arrays[i].second;
+        for (size_t j = 0; j < array->Size(); j++) {
+            FlatVariable flat;
+            FillVariable((*array)[static_cast<int>(j)], flat, arrays);
+            elements_[first + j] = flat;
+        }
+    }
+}
+
+const FlatSection* FlatView::FindSection(std::string_view path, const FlatSection* from) const {
+    const FlatSection* section = from != nullptr ? from : &sections[0];
+    while (!path.empty()) {
+        size_t dot = path.find('.');
+        std::string_view name = path.substr(0, dot);
+        const FlatSection* next = nullptr;
+        for (uint32_t i = 0; i < section->children.count; i++) {
+            const FlatSection& child = sections[section->children.first + i];
+            if (Text(child.name) == name) {
+                next = &child;
+                break;
+            }
+        }
+        if (next == nullptr) {
+            return nullptr;
+        }
+        section = next;
+        path = dot == std::string_view::npos ? std::string_view() : path.substr(dot + 1);
+    }
+    return section;
+}
+
+const FlatVariable* FlatView::FindVariable(std::string_view path, const FlatSection* from) const {
+    size_t dot = path.rfind('.');
+    const FlatSection* section = from != nullptr ? from : &sections[0];
+    if (dot != std::string_view::npos) {
+        section = FindSection(path.substr(0, dot), section);
+    }
+    if (section == nullptr) {
+        return nullptr;
+    }
+    std::string_view name = dot == std::string_view::npos ? path : path.substr(dot + 1);
+    for (uint32_t i = 0; i < section->variables.count; i++) {
+        const FlatVariable& variable = variables[section->variables.first + i];
+        if (Text(variable.name) == name) {
+            return &variable;
+        }
+    }
+    return nullptr;
+}
+
+FlatDocument omfl::Flatten(const Parser& parser) {
+    return FlatDocument(parser);
+}
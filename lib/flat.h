@@ -0,0 +1,107 @@
+#pragma once
+
+#include "parser.h"
+
+#include <cstdint>
+
+namespace omfl {
+
+    // A run of entries in one of the FlatDocument tables, or of bytes in its
+    // string pool.
+    struct FlatRange {
+        uint32_t first = 0;
+        uint32_t count = 0;
+    };
+
+    struct FlatSection {
+        FlatRange name;
+        uint32_t parent = 0;
+        FlatRange children;
+        FlatRange variables;
+    };
+
+    // `value` is the string bytes of a STRING or the elements of an ARRAY.
+    struct FlatVariable {
+        FlatRange name;
+        TYPE type = UNDEFINED;
+        int int_value = 0;
+        float float_value = 0;
+        bool bool_value = false;
+        FlatRange value;
+    };
+
+    // The tables of a flattened document, wherever they are stored: in a
+    // FlatDocument or in a shared memory segment (see shared.h).
+    struct FlatView {
+        const FlatSection* sections = nullptr;
+        const FlatVariable* variables = nullptr;
+        const FlatVariable* elements = nullptr;
+        std::string_view strings;
+
+        [[nodiscard]] std::string_view Text(FlatRange range) const {
+            return strings.substr(range.first, range.count);
+        }
+
+        // Dotted path relative to `from`, the root section by default.
+        [[nodiscard]] const FlatSection* FindSection(std::string_view path, const FlatSection* from = nullptr) const;
+
+        [[nodiscard]] const FlatVariable* FindVariable(std::string_view path, const FlatSection* from = nullptr) const;
+    };
+
+    // Read-only copy of a parsed document laid out breadth-first in
+    // contiguous tables: the children of a section are adjacent in
+    // `sections`, its variables adjacent in `variables`, and the items of an
+    // array adjacent in `elements`. Names and strings share one pool.
+    class FlatDocument {
+        std::vector<FlatSection> sections_;
+        std::vector<FlatVariable> variables_;
+        std::vector<FlatVariable> elements_;
+        std::string strings_;
+
+        FlatRange AddString(const std::string& value);
+
+        void FillVariable(Variable& source, FlatVariable& target, std::vector<std::pair<uint32_t, Array*>>& arrays);
+
+    public:
+        explicit FlatDocument(const Parser& parser);
+
+        [[nodiscard]] const std::vector<FlatSection>& Sections() const {
+            return sections_;
+        }
+
+        [[nodiscard]] const std::vector<FlatVariable>& Variables() const {
+            return variables_;
+        }
+
+        [[nodiscard]] const std::vector<FlatVariable>& Elements() const {
+            return elements_;
+        }
+
+        [[nodiscard]] const std::string& Strings() const {
+            return strings_;
+        }
+
+        [[nodiscard]] const FlatSection& Root() const {
+            return sections_[0];
+        }
+
+        [[nodiscard]] std::string_view Text(FlatRange range) const {
+            return std::string_view(strings_).substr(range.first, range.count);
+        }
+
+        [[nodiscard]] FlatView View() const {
+            return {sections_.data(), variables_.data(), elements_.data(), strings_};
+        }
+
+        // Exact dotted path from the root section, e.g. "servers.first.ip".
+        [[nodiscard]] const FlatSection* FindSection(std::string_view path) const {
+            return View().FindSection(path);
+        }
+
+        [[nodiscard]] const FlatVariable* FindVariable(std::string_view path) const {
+            return View().FindVariable(path);
+        }
+    };
+
+    FlatDocument Flatten(const Parser& parser);
+}// namespace
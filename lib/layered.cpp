@@ -0,0 +1,69 @@
+#include "layered.h"
+
+using namespace omfl;
+
+namespace {
+
+    void Collect(Section& section, const std::string& prefix, std::unordered_map<std::string, Variable*>& keys) {
+        for (Variable* variable : section.GetArr()) {
+            keys.emplace(prefix + variable->GetName(), variable);
+        }
+        for (Section* child : section.GetSectionChild()) {
+            Collect(*child, prefix + child->GetName() + ".", keys);
+        }
+    }
+
+}// namespace
+
+Layered::Layered(std::vector<Parser> layers) : layers_(std::move(layers)), keys_(layers_.size()) {
+    for (size_t i = 0; i < layers_.size(); i++) {
+        Collect(layers_[i].Global(), "", keys_[i]);
+        for (const auto& [path, variable] : keys_[i]) {
+            index_[path] = {i, variable};
+        }
+    }
+}
+
+void Layered::Resolve(const std::string& path) {
+    for (size_t i = layers_.size(); i > 0; i--) {
+        auto it = keys_[i - 1].find(path);
+        if (it != keys_[i - 1].end()) {
+            index_[path] = {i - 1, it->second};
+            return;
+        }
+    }
+    index_.erase(path);
+}
+
+Variable* Layered::Find(const std::string& path) const {
+    auto it = index_.find(path);
+    return it == index_.end() ? nullptr : it->second.variable;
+}
+
+Element& Layered::Get(const std::string& path) const {
+    Variable* variable = Find(path);
+    if (variable == nullptr) {
+        throw std::invalid_argument("Invalid argument");
+    }
+    return *variable;
+}
+
+size_t Layered::LayerOf(const std::string& path) const {
+    auto it = index_.find(path);
+    return it == index_.end() ? layers_.size() : it->second.layer;
+}
+
+void Layered::Replace(size_t layer, Parser document) {
+    std::unordered_map<std::string, Variable*> previous = std::move(keys_[layer]);
+    layers_[layer] = std::move(document);
+    keys_[layer].clear();
+    Collect(layers_[layer].Global(), "", keys_[layer]);
+    for (const auto& entry : previous) {
+        Resolve(entry.first);
+    }
+    for (const auto& entry : keys_[layer]) {
+        if (previous.count(entry.first) == 0) {
+            Resolve(entry.first);
+        }
+    }
+}
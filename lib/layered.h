@@ -0,0 +1,44 @@
+#pragma once
+
+#include "parser.h"
+
+namespace omfl {
+
+    // Effective view over a stack of documents, layer 0 being the base and
+    // the last layer the most specific one. Every key path is resolved up
+    // front to the top-most layer defining it, so lookups do not depend on
+    // the number of layers. Replacing a layer re-resolves only the paths that
+    // the old or the new version of that layer defines.
+    class Layered {
+        struct Resolved {
+            size_t layer;
+            Variable* variable;
+        };
+
+        std::vector<Parser> layers_;
+        std::vector<std::unordered_map<std::string, Variable*>> keys_;
+        std::unordered_map<std::string, Resolved> index_;
+
+        void Resolve(const std::string& path);
+
+    public:
+        explicit Layered(std::vector<Parser> layers);
+
+        [[nodiscard]] size_t Size() const {
+            return layers_.size();
+        }
+
+        [[nodiscard]] const Parser& Layer(size_t layer) const {
+            return layers_[layer];
+        }
+
+        [[nodiscard]] Variable* Find(const std::string& path) const;
+
+        [[nodiscard]] Element& Get(const std::string& path) const;
+
+        // Layer that currently provides `path`, or Size() when none does.
+        [[nodiscard]] size_t LayerOf(const std::string& path) const;
+
+        void Replace(size_t layer, Parser document);
+    };
+}// namespace
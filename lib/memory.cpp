@@ -0,0 +1,187 @@
+#include "memory.h"
+
+#include <cstring>
+#include <unordered_set>
+
+using namespace omfl;
+
+namespace omfl {
+
+    // Measures and trims the containers of the node classes, which declare it
+    // a friend.
+    class Footprint {
+        MemoryReport report_;
+        std::unordered_set<const void*> seen_;
+        std::unordered_multimap<uint64_t, Variable*> canonical_;
+
+        void AddString(const std::string& text) {
+            if (text.capacity() > std::string().capacity()) {
+                report_.strings += text.size() + 1;
+                report_.slack += text.capacity() - text.size();
+            }
+        }
+
+        template <typename T>
+        void AddVector(const std::vector<T>& list, size_t& bucket) {
+            bucket += list.size() * sizeof(T);
+            report_.slack += (list.capacity() - list.size()) * sizeof(T);
+        }
+
+        template <typename Index>
+        void AddIndex(const Index& index, size_t& bucket) {
+            bucket += index.bucket_count() * sizeof(void*) +
+                      index.size() * (sizeof(typename Index::value_type) + sizeof(void*) + sizeof(size_t));
+        }
+
+        // Walks nested arrays with a worklist, so deep nesting does not
+        // recurse.
+        void AddVariable(Variable* variable) {
+            std::vector<Variable*> pending{variable};
+            while (!pending.empty()) {
+                Variable* current = pending.back();
+                pending.pop_back();
+                if (!seen_.insert(current).second) {
+                    continue;
+                }
+                AddString(current->name_);
+                if (current->IsArray()) {
+                    Array* array = static_cast<Array*>(current);
+                    report_.array_count++;
+                    report_.arrays += sizeof(Array);
+                    AddVector(array->var_array, report_.arrays);
+                    pending.insert(pending.end(), array->var_array.begin(), array->var_array.end());
+                    continue;
+                }
+                report_.variable_count++;
+                if (current->IsString()) {
+                    report_.variables += sizeof(StringVar);
+                    AddString(static_cast<StringVar*>(current)->value_);
+                } else if (current->IsInt()) {
+                    report_.variables += sizeof(IntVar);
+                } else if (current->IsBool()) {
+                    report_.variables += sizeof(BoolVar);
+                } else {
+                    report_.variables += sizeof(FloatVar);
+                }
+            }
+        }
+
+        void AddSection(Section* section, bool embedded) {
+            if (!seen_.insert(section).second) {
+                return;
+            }
+            report_.section_count++;
+            report_.sections += embedded ? 0 : sizeof(Section);
+            AddString(section->name_);
+            AddVector(section->var_list, report_.sections);
+            AddVector(section->child_section, report_.sections);
+            AddIndex(section->var_index, report_.sections);
+            AddIndex(section->child_index, report_.sections);
+            for (Variable* variable : section->var_list) {
+                AddVariable(variable);
+            }
+        }
+
+        static bool SameValue(Variable* first, Variable* second) {
+            if (first->IsString()) {
+                return second->IsString() && static_cast<StringVar*>(first)->value_ ==
+                                             static_cast<StringVar*>(second)->value_;
+            } else if (first->IsInt()) {
+                return second->IsInt() && static_cast<IntVar*>(first)->GetValue() ==
+                                          static_cast<IntVar*>(second)->GetValue();
+            } else if (first->IsBool()) {
+                return second->IsBool() && static_cast<BoolVar*>(first)->GetValue() ==
+                                           static_cast<BoolVar*>(second)->GetValue();
+            }
+            float first_value = static_cast<FloatVar*>(first)->GetValue();
+            float second_value = static_cast<FloatVar*>(second)->GetValue();
+            return second->IsFloat() && std::memcmp(&first_value, &second_value, sizeof(float)) == 0;
+        }
+
+        Variable* CanonicalScalar(Variable* variable) {
+            uint64_t key = HashVariable(variable).low;
+            auto range = canonical_.equal_range(key);
+            for (auto it = range.first; it != range.second; it++) {
+                if (it->second == variable ||
+                    (it->second->name_ == variable->name_ && SameValue(it->second, variable))) {
+                    return it->second;
+                }
+            }
+            canonical_.emplace(key, variable);
+            if (variable->IsString()) {
+                static_cast<StringVar*>(variable)->value_.shrink_to_fit();
+            }
+            return variable;
+        }
+
+        // Arrays keep their identity and have their elements shared instead.
+        // Nested arrays are visited from a worklist rather than recursively.
+        Variable* Canonical(Variable* variable) {
+            if (!variable->IsArray()) {
+                return CanonicalScalar(variable);
+            }
+            std::vector<Array*> pending{static_cast<Array*>(variable)};
+            while (!pending.empty()) {
+                Array* array = pending.back();
+                pending.pop_back();
+                if (!seen_.insert(array).second) {
+                    continue;
+                }
+                for (Variable*& element : array->var_array) {
+                    if (element->IsArray()) {
+                        pending.push_back(static_cast<Array*>(element));
+                    } else {
+                        element = CanonicalScalar(element);
+                    }
+                }
+                array->var_array.shrink_to_fit();
+            }
+            return variable;
+        }
+
+    public:
+        static MemoryReport Measure(const Parser& parser) {
+            Footprint footprint;
+            MemoryReport& report = footprint.report_;
+            report.document = sizeof(Parser) - sizeof(Section);
+            footprint.AddString(parser.name);
+            footprint.AddString(parser.path_);
+            footprint.AddVector(parser.section_list, report.document);
+            footprint.AddVector(parser.diagnostics, report.document);
+            for (Section* section : parser.section_list) {
+                footprint.AddSection(section, section == parser.section_list[0]);
+            }
+            return report;
+        }
+
+        static void Compact(Parser& parser) {
+            Footprint footprint;
+            for (Section* section : parser.section_list) {
+                for (Variable*& variable : section->var_list) {
+                    Variable* canonical = footprint.Canonical(variable);
+                    if (canonical != variable) {
+                        section->var_index.erase(variable->name_);
+                        section->var_index.emplace(canonical->name_, canonical);
+                        variable = canonical;
+                    }
+                }
+                section->var_list.shrink_to_fit();
+                section->child_section.shrink_to_fit();
+                section->var_index.rehash(0);
+                section->child_index.rehash(0);
+            }
+            parser.name.shrink_to_fit();
+            parser.path_.shrink_to_fit();
+            parser.section_list.shrink_to_fit();
+            parser.diagnostics.shrink_to_fit();
+        }
+    };
+}// namespace
+
+MemoryReport omfl::MemoryUsage(const Parser& parser) {
+    return Footprint::Measure(parser);
+}
+
+void omfl::Compact(Parser& parser) {
+    Footprint::Compact(parser);
+}
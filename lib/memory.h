@@ -0,0 +1,42 @@
+#pragma once
+
+#include "parser.h"
+
+namespace omfl {
+
+    // Bytes held by one document. Nodes reachable from several places, e.g.
+    // shared by Compact or by versions produced with an Editor, are counted
+    // once. Sizes of the hash indexes are estimated from their node and
+    // bucket counts.
+    struct MemoryReport {
+        // Parser object, its section list, diagnostics and own strings.
+        size_t document = 0;
+        // Section objects with their variable and child lists and indexes.
+        size_t sections = 0;
+        // Int, string, bool and float variable objects.
+        size_t variables = 0;
+        // Array objects and their element lists.
+        size_t arrays = 0;
+        // Heap buffers of names and string values.
+        size_t strings = 0;
+        // Allocated but unused capacity of the lists and strings above.
+        size_t slack = 0;
+
+        size_t section_count = 0;
+        size_t variable_count = 0;
+        size_t array_count = 0;
+
+        [[nodiscard]] size_t Total() const {
+            return document + sections + variables + arrays + strings + slack;
+        }
+    };
+
+    MemoryReport MemoryUsage(const Parser& parser);
+
+    // Makes variables with equal names and values, including array elements,
+    // share one node, and releases the spare capacity of every list, string
+    // value and index of the document. Names keep their capacity, because the
+    // indexes hold views of them. Sections shared with other documents are
+    // compacted in place, so no other thread may read those meanwhile.
+    void Compact(Parser& parser);
+}// namespace
@@ -1,7 +1,15 @@
 #include "parser.h"
 
+#include <charconv>
+#include <cstring>
+#include <fstream>
 #include <utility>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define OMFL_SSE2
+#endif
+
 using namespace omfl;
 
 bool Element::IsInt() {
@@ -124,34 +132,112 @@ Variable& Variable::operator[](int index) {
     }
 }
 
+void Section::AddVar(Variable* variable) {
+    var_index.emplace(variable->name_, variable);
+    var_list.push_back(variable);
+    hash_ += HashVariable(variable);
+}
+
+void Section::RebuildIndexes() {
+    var_index.clear();
+    for (Variable* variable : var_list) {
+        var_index.emplace(variable->name_, variable);
+    }
+    child_index.clear();
+    for (Section* child : child_section) {
+        child_index.emplace(child->name_, child);
+    }
+}
+
 void Section::AddNewIntVar(std::string& name, int value) {
-    IntVar* int_var = new IntVar(value, std::move(name));
-    var_list.push_back(int_var);
+    if (HasVar(name)) {
+        throw std::invalid_argument("Invalid argument");
+    }
+    AddVar(new IntVar(value, std::move(name)));
 }
 
 void Section::AddNewStringVar(std::string& name, std::string value) {
-    StringVar* string_var = new StringVar(std::move(value), std::move(name));
-    var_list.push_back(string_var);
+    if (HasVar(name)) {
+        throw std::invalid_argument("Invalid argument");
+    }
+    AddVar(new StringVar(std::move(value), std::move(name)));
 }
 
 void Section::AddNewBoolVar(std::string& name, bool value) {
-    BoolVar* bool_var = new BoolVar(value, std::move(name));
-    var_list.push_back(bool_var);
+    if (HasVar(name)) {
+        throw std::invalid_argument("Invalid argument");
+    }
+    AddVar(new BoolVar(value, std::move(name)));
 }
 
 void Section::AddNewFloatVar(std::string& name, float value) {
-    FloatVar* float_var = new FloatVar(value, std::move(name));
-    var_list.push_back(float_var);
+    if (HasVar(name)) {
+        throw std::invalid_argument("Invalid argument");
+    }
+    AddVar(new FloatVar(value, std::move(name)));
 }
 
 void Section::AddNewArray(std::string name, Array& array) {
-    Array* new_array = &array;
-    new_array->SetName(std::move(name));
-    var_list.push_back(new_array);
+    if (HasVar(name)) {
+        throw std::invalid_argument("Invalid argument");
+    }
+    array.SetName(std::move(name));
+    AddVar(&array);
+}
+
+void Section::SetVar(Variable* variable) {
+    auto it = var_index.find(variable->name_);
+    if (it == var_index.end()) {
+        AddVar(variable);
+        return;
+    }
+    hash_ -= HashVariable(it->second);
+    std::replace(var_list.begin(), var_list.end(), it->second, variable);
+    var_index.erase(it);
+    var_index.emplace(variable->name_, variable);
+    hash_ += HashVariable(variable);
+}
+
+bool Section::RemoveVar(const std::string& name) {
+    auto it = var_index.find(name);
+    if (it == var_index.end()) {
+        return false;
+    }
+    hash_ -= HashVariable(it->second);
+    var_list.erase(std::find(var_list.begin(), var_list.end(), it->second));
+    var_index.erase(it);
+    return true;
+}
+
+bool Section::RemoveChild(const std::string& name) {
+    auto it = child_index.find(name);
+    if (it == child_index.end()) {
+        return false;
+    }
+    child_section.erase(std::find(child_section.begin(), child_section.end(), it->second));
+    child_index.erase(it);
+    return true;
+}
+
+void Section::ReplaceChild(Section* old_child, Section* new_child) {
+    std::replace(child_section.begin(), child_section.end(), old_child, new_child);
+    // The key views the old child's name, so it is replaced together with
+    // the value.
+    child_index.erase(old_child->name_);
+    child_index.emplace(new_child->name_, new_child);
+}
+
+void Parser::RebuildSectionList() {
+    section_list.assign(1, &global_section);
+    for (size_t i = 0; i < section_list.size(); i++) {
+        for (Section* child : section_list[i]->GetSectionChild()) {
+            section_list.push_back(child);
+        }
+    }
 }
 
 Section& Parser::AddNewSection(std::string& name, std::string parent_name) {
-    Section* parent = new Section();
+    Section* parent = nullptr;
     bool find_parent = false;
     for (int i = 0; i < section_list.size(); i++) {
         if (section_list[i]->GetName() == parent_name) {
@@ -161,15 +247,17 @@ Section& Parser::AddNewSection(std::string& name, std::string parent_name) {
         }
     }
     if (find_parent) {
-        Section* new_section = new Section(name, parent);
-        parent->GetSectionChild().push_back(new_section);
-        section_list.push_back(new_section);
+        return AddNewSection(name, parent);
     } else {
-        Section* new_section = new Section(name, section_list[0]);
-        global_section.GetSectionChild().push_back(new_section);
-        section_list.push_back(new_section);
+        return AddNewSection(name, &global_section);
     }
-    return *section_list.back();
+}
+
+Section& Parser::AddNewSection(const std::string& name, Section* parent) {
+    Section* new_section = new Section(name, parent);
+    parent->SetChild(new_section);
+    section_list.push_back(new_section);
+    return *new_section;
 }
 
 std::string Element::GetName() {
@@ -190,15 +278,11 @@ Element& Element::Get(std::string name_variable) {
 Element& Section::Get(std::string name_variable) {
     Section* current_section = this;
     if (name_variable.find('.') == std::string::npos) {
-        for (int i = 0; i < current_section->child_section.size(); i++) {
-            if (current_section->child_section[i]->GetName() == name_variable) {
-                return *current_section->child_section[i];
-            }
+        if (Section* child = current_section->FindChild(name_variable)) {
+            return *child;
         }
-        for (int i = 0; i < current_section->var_list.size(); i++) {
-            if (current_section->var_list[i]->GetName() == name_variable) {
-                return *current_section->var_list[i];
-            }
+        if (Variable* variable = current_section->FindVar(name_variable)) {
+            return *variable;
         }
     } else {
         std::istringstream name_stream(name_variable);
@@ -207,15 +291,11 @@ Element& Section::Get(std::string name_variable) {
         while (std::getline(name_stream, element, '.')) {
             element_list.push_back(element);
         }
-        for (int i = 0; i < current_section->child_section.size(); i++) {
-            if (current_section->child_section[i]->GetName() == element_list.back()) {
-                return *current_section->child_section[i];
-            }
+        if (Section* child = current_section->FindChild(element_list.back())) {
+            return *child;
         }
-        for (int i = 0; i < current_section->var_list.size(); i++) {
-            if (current_section->var_list[i]->GetName() == element_list.back()) {
-                return *current_section->var_list[i];
-            }
+        if (Variable* variable = current_section->FindVar(element_list.back())) {
+            return *variable;
         }
     }
 }
@@ -225,12 +305,8 @@ Element& Parser::Get(std::string name_variable) const {
         for (int i = 0; i < this->section_list.size(); i++) {
             if (this->section_list[i]->GetName() == name_variable) {
                 return *this->section_list[i];
-            } else {
-                for (int j = 0; j < this->section_list[i]->GetArr().size(); j++) {
-                    if (this->section_list[i]->GetArr()[j]->GetName() == name_variable) {
-                        return *this->section_list[i]->GetArr()[j];
-                    }
-                }
+            } else if (Variable* variable = this->section_list[i]->FindVar(name_variable)) {
+                return *variable;
             }
         }
     } else {
@@ -243,63 +319,49 @@ Element& Parser::Get(std::string name_variable) const {
         for (int i = 0; i < this->section_list.size(); i++) {
             if (this->section_list[i]->GetName() == element_list.back()) {
                 return *this->section_list[i];
-            } else {
-                for (int j = 0; j < this->section_list[i]->GetArr().size(); j++) {
-                    if (this->section_list[i]->GetArr()[j]->GetName() == element_list.back()) {
-                        return *this->section_list[i]->GetArr()[j];
-                    }
-                }
+            } else if (Variable* variable = this->section_list[i]->FindVar(element_list.back())) {
+                return *variable;
             }
         }
     }
 }
 
-bool IsNum(std::string num) {
+bool IsNum(std::string_view num) {
+    if (num.empty()) {
+        return false;
+    }
     if (num[0] == '+' || num[0] == '-') {
         if (num.size() == 1) {
             return false;
         } else {
-            int i = 1;
-            while (num[i] != '\0') {
+            for (size_t i = 1; i < num.size(); i++) {
                 if ((num[i] == '.' && i == 1) || (!std::isdigit(num[i]) && num[i] != '.') ||
                     (num[i] == '.' && i == num.size() - 1)) {
                     return false;
                 }
-                i++;
             }
         }
     } else {
-        int i = 0;
-        while (num[i] != '\0') {
+        for (size_t i = 0; i < num.size(); i++) {
             if ((num[i] == '.' && i == 0) || (!std::isdigit(num[i]) && num[i] != '.') ||
                 (num[i] == '.' && i == num.size() - 1)) {
                 return false;
             }
-            i++;
-        }
-    }
-    return true;
-}
-
-bool IsString(std::string line_value) {
-    int i = 1;
-    while (i != line_value.size() - 1) {
-        if (line_value[i] == '\"') {
-            return false;
         }
-        i++;
     }
     return true;
 }
 
-TYPE omfl::TypeVar(std::string line_value) {
-    if (line_value.back() == '\"' && line_value.front() == '\"') {
+TYPE omfl::TypeVar(std::string_view line_value) {
+    if (line_value.empty()) {
+        return UNDEFINED;
+    } else if (line_value.size() >= 2 && line_value.back() == '\"' && line_value.front() == '\"') {
         return STRING;
     } else if (line_value == "true" || line_value == "false") {
         return BOOL;
-    } else if (line_value.find('.') != std::string::npos &&
+    } else if (line_value.find('.') != std::string_view::npos &&
                std::count(line_value.begin(), line_value.end(), '.') == 1 &&
-               IsNum(line_value) && line_value.size() != 0) {
+               IsNum(line_value)) {
         return FLOAT;
     } else if (line_value.front() == '[' && line_value.back() == ']') {
         return ARRAY;
@@ -310,48 +372,222 @@ TYPE omfl::TypeVar(std::string line_value) {
     }
 }
 
-void omfl::TakeToStr(std::string& line) {
-    if (line.find('#') != std::string::npos) {
-        line.erase(line.find('#'));
+namespace {
+
+    // murmur3 finalizer
+    uint64_t Mix(uint64_t x) {
+        x ^= x >> 33;
+        x *= 0xff51afd7ed558ccdULL;
+        x ^= x >> 33;
+        x *= 0xc4ceb3fe1a85ec53ULL;
+        x ^= x >> 33;
+        return x;
     }
-    int i = 0;
-    while (line[i] == ' ' || line[i] == '\t') {
-        i++;
+
+    Hash128 HashBytes(std::string_view bytes, uint64_t tag) {
+        Hash128 hash{0x9e3779b97f4a7c15ULL ^ tag, 0xc2b2ae3d27d4eb4fULL + tag};
+        for (size_t i = 0; i < bytes.size(); i += 8) {
+            uint64_t word = 0;
+            std::memcpy(&word, bytes.data() + i, std::min<size_t>(8, bytes.size() - i));
+            hash.low = Mix(hash.low ^ word);
+            hash.high = Mix(hash.high + word * 0x9e3779b97f4a7c15ULL);
+        }
+        hash.low = Mix(hash.low ^ bytes.size());
+        hash.high = Mix(hash.high ^ (bytes.size() * 0xc2b2ae3d27d4eb4fULL));
+        return hash;
     }
-    line.erase(0, i);
-    i = line.size() - 1;
-    while (line[i] == ' ' || line[i] == '\t') {
-        i--;
+
+    Hash128 Combine(const Hash128& first, const Hash128& second) {
+        return {Mix(first.low ^ Mix(second.low + 0x9e3779b97f4a7c15ULL)),
+                Mix(first.high + Mix(second.high ^ 0xc2b2ae3d27d4eb4fULL))};
+    }
+
+    template <typename T>
+    Hash128 HashScalar(T value, TYPE type) {
+        char bytes[sizeof(T)];
+        std::memcpy(bytes, &value, sizeof(T));
+        return HashBytes(std::string_view(bytes, sizeof(T)), type);
     }
-    line.erase(i + 1);
-    int index = line.find('=');
-    i = index;
-    while (line[i - 1] == ' ' || line[i] == '\t') {
+
+    Hash128 HashScalarValue(Variable* variable) {
+        if (variable->IsInt()) {
+            return HashScalar(static_cast<IntVar*>(variable)->GetValue(), INT);
+        } else if (variable->IsString()) {
+            return HashBytes(static_cast<StringVar*>(variable)->GetValue(), STRING);
+        } else if (variable->IsBool()) {
+            return HashScalar(static_cast<BoolVar*>(variable)->GetValue(), BOOL);
+        } else if (variable->IsFloat()) {
+            return HashScalar(static_cast<FloatVar*>(variable)->GetValue(), FLOAT);
+        }
+        return HashBytes({}, UNDEFINED);
+    }
+
+    // Post-order over nested arrays with an explicit stack, so that the depth
+    // of a hostile array costs heap rather than call stack.
+    Hash128 HashValue(Variable* variable) {
+        if (!variable->IsArray()) {
+            return HashScalarValue(variable);
+        }
+        struct Frame {
+            Array* array;
+            size_t next;
+            Hash128 hash;
+        };
+        std::vector<Frame> stack;
+        Array* root = static_cast<Array*>(variable);
+        stack.push_back({root, 0, HashScalar(root->Size(), ARRAY)});
+        while (true) {
+            Frame& top = stack.back();
+            if (top.next < top.array->Size()) {
+                Variable* element = &(*top.array)[static_cast<int>(top.next++)];
+                if (element->IsArray()) {
+                    Array* nested = static_cast<Array*>(element);
+                    stack.push_back({nested, 0, HashScalar(nested->Size(), ARRAY)});
+                } else {
+                    top.hash = Combine(top.hash, HashScalarValue(element));
+                }
+                continue;
+            }
+            Hash128 hash = top.hash;
+            stack.pop_back();
+            if (stack.empty()) {
+                return hash;
+            }
+            stack.back().hash = Combine(stack.back().hash, hash);
+        }
+    }
+
+    void AppendUtf8(std::string& out, uint32_t code) {
+        if (code < 0x80) {
+            out.push_back(static_cast<char>(code));
+        } else if (code < 0x800) {
+            out.push_back(static_cast<char>(0xC0 | code >> 6));
+            out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+        } else if (code < 0x10000) {
+            out.push_back(static_cast<char>(0xE0 | code >> 12));
+            out.push_back(static_cast<char>(0x80 | (code >> 6 & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+        } else {
+            out.push_back(static_cast<char>(0xF0 | code >> 18));
+            out.push_back(static_cast<char>(0x80 | (code >> 12 & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | (code >> 6 & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+        }
+    }
+
+}// namespace
+
+bool omfl::ValidUtf8(std::string_view bytes) {
+    size_t i = 0;
+    while (i < bytes.size()) {
+#ifdef OMFL_SSE2
+        while (bytes.size() - i >= 16) {
+            __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes.data() + i));
+            int high_bits = _mm_movemask_epi8(block);
+            if (high_bits != 0) {
+                while ((high_bits & 1) == 0) {
+                    high_bits >>= 1;
+                    i++;
+                }
+                break;
+            }
+            i += 16;
+        }
+        if (i == bytes.size()) {
+            break;
+        }
+#endif
+        size_t length = Utf8SequenceLength(bytes, i);
+        if (length == 0) {
+            return false;
+        }
+        i += length;
+    }
+    return true;
+}
+
+bool omfl::DecodeString(std::string_view body, std::string_view& text, std::string* storage) {
+    if (!ValidUtf8(body)) {
+        return false;
+    }
+    size_t special = body.find_first_of("\"\\");
+    if (special == std::string_view::npos) {
+        text = body;
+        return true;
+    }
+    if (storage != nullptr) {
+        storage->clear();
+    }
+    size_t i = 0;
+    while (special != std::string_view::npos) {
+        if (storage != nullptr) {
+            storage->append(body.data() + i, special - i);
+        }
+        uint32_t code = 0;
+        size_t length = body[special] == '\"' ? 0 : DecodeEscape(body, special, code);
+        if (length == 0) {
+            return false;
+        }
+        if (storage != nullptr) {
+            AppendUtf8(*storage, code);
+        }
+        i = special + length;
+        special = body.find_first_of("\"\\", i);
+    }
+    if (storage != nullptr) {
+        storage->append(body.data() + i, body.size() - i);
+        text = *storage;
+    } else {
+        text = body;
+    }
+    return true;
+}
+
+Hash128 omfl::HashVariable(Variable* variable) {
+    return Combine(HashBytes(variable->GetName(), VARIABLE), HashValue(variable));
+}
+
+Hash128 omfl::HashSectionEntry(const std::string& name, const Hash128& contents) {
+    return Combine(HashBytes(name, SECTION), contents);
+}
+
+void omfl::TakeToStr(std::string& line) {
+    size_t comment = FindComment(line);
+    if (comment != std::string::npos) {
+        line.erase(comment);
+    }
+    DeleteWhiteSpaces(line);
+    size_t index = line.find('=');
+    if (index == std::string::npos) {
+        return;
+    }
+    size_t i = index;
+    while (i > 0 && (line[i - 1] == ' ' || line[i - 1] == '\t')) {
         i--;
     }
     line.erase(i, index - i);
-    index = line.find('=');
+    index = i;
     i = index + 1;
-    while (line[i] == ' ' || line[i] == '\t') {
+    while (i < line.size() && (line[i] == ' ' || line[i] == '\t')) {
         i++;
     }
     line.erase(index + 1, i - index - 1);
 }
 
 void omfl::DeleteWhiteSpaces(std::string& line) {
-    int i = 0;
-    while (line[i] == ' ' || line[i] == '\t') {
+    size_t i = 0;
+    while (i < line.size() && (line[i] == ' ' || line[i] == '\t')) {
         i++;
     }
     line.erase(0, i);
-    i = line.size() - 1;
-    while (line[i] == ' ' || line[i] == '\t') {
+    i = line.size();
+    while (i > 0 && (line[i - 1] == ' ' || line[i - 1] == '\t')) {
         i--;
     }
-    line.erase(i + 1);
+    line.erase(i);
 }
 
-ELEMENT omfl::CheckElement(std::string current_line) {
+ELEMENT omfl::CheckElement(const std::string& current_line) {
     if (current_line.find('=') != std::string::npos) {
         return VARIABLE;
     } else if (current_line[0] == '[' && current_line[current_line.size() - 1] == ']') {
@@ -365,7 +601,7 @@ ELEMENT omfl::CheckElement(std::string current_line) {
     }
 }
 
-bool omfl::CheckVarName(std::string line_name) {
+bool omfl::CheckVarName(const std::string& line_name) {
     if (line_name.size() == 0) {
         return false;
     } else {
@@ -381,68 +617,35 @@ bool omfl::CheckVarName(std::string line_name) {
     }
 }
 
-std::pair<std::string, std::string> omfl::ParseVar(std::string current_var) {
-    int i = 0;
-    std::string name_var;
-    std::string value;
-    while (current_var[i] != '=') {
-        name_var += current_var[i];
-        i++;
-    }
-    i++;
-    while (current_var[i] != '\0') {
-        value += current_var[i];
-        i++;
-    }
-    return std::make_pair(name_var, value);
+std::pair<std::string, std::string> omfl::ParseVar(const std::string& current_var) {
+    size_t equals = current_var.find('=');
+    return std::make_pair(current_var.substr(0, equals), current_var.substr(equals + 1));
 }
 
-bool omfl::CheckSection(std::string section) {
-    if (section.size() == 0 || section.find('.') == 0 || section.find('.') == section.size() - 1) {
+bool omfl::CheckSection(const std::string& section) {
+    if (section.empty() || section.front() == '.' || section.find('.') == section.size() - 1) {
         return false;
     }
-    std::istringstream section_stream(section);
-    std::string section_value;
-    while (std::getline(section_stream, section_value, '.')) {
-        if (section_value.empty() || section.find(']') != std::string::npos || section.find('[') != std::string::npos) {
-            return false;
-        }
-    }
-    return true;
+    return section.find("..") == std::string::npos && section.find_first_of("[]") == std::string::npos;
 }
 
-bool omfl::CheckVarValue(std::string line_value) {
+bool omfl::CheckVarValue(std::string_view line_value) {
     if (line_value.size() == 0) {
         return false;
     } else {
         if (TypeVar(line_value) == UNDEFINED) {
             return false;
         } else if (TypeVar(line_value) == INT) {
-            if (line_value.front() != '+' && line_value.front() != '-') {
-                int i = 0;
-                while (line_value[i] != '\0') {
-                    if (!std::isdigit(line_value[i])) {
-                        return false;
-                    }
-                    i++;
-                }
-                return true;
-            } else {
-                int i = 1;
-                while (line_value[i] != '\0') {
-                    if (!std::isdigit(line_value[i])) {
-                        return false;
-                    }
-                    i++;
+            size_t i = (line_value.front() == '+' || line_value.front() == '-') ? 1 : 0;
+            for (; i < line_value.size(); i++) {
+                if (!std::isdigit(line_value[i])) {
+                    return false;
                 }
-                return true;
             }
+            return true;
         } else if (TypeVar(line_value) == STRING) {
-            if (IsString(line_value)) {
-                return true;
-            } else {
-                return false;
-            }
+            std::string_view text;
+            return DecodeString(line_value.substr(1, line_value.size() - 2), text, nullptr);
         } else if (TypeVar(line_value) == BOOL) {
             return true;
         } else if (TypeVar(line_value) == FLOAT) {
@@ -454,176 +657,831 @@ bool omfl::CheckVarValue(std::string line_value) {
                 }
             }
         } else if (TypeVar(line_value) == ARRAY) {
-            std::stack<char> stack;
-            size_t quotes = 0;
-            size_t bracket = 0;
-            for (int i = 1; i < line_value.size() - 1; i++) {
-                if (line_value[i] == '[' && quotes % 2 == 0) {
-                    stack.push(line_value[i]);
-                } else if (line_value[i] == '\"' && bracket == 0) {
-                    quotes = quotes + 1;
-                } else if (line_value[i] == ']' && quotes % 2 == 0) {
-                    if (stack.top() == '[') {
-                        stack.pop();
-                    }
-                } else if (line_value[i] == ';' && quotes % 2 == 0) {
-                    return false;
-                }
+            return CountArrayElements(line_value, nullptr);
+        }
+    }
+    return true;
+}
+
+bool omfl::CountArrayElements(std::string_view array, std::vector<size_t>* counts) {
+    std::vector<size_t> open;
+    bool in_string = false;
+    bool in_comment = false;
+    for (size_t i = 0; i < array.size(); i++) {
+        if (in_comment) {
+            if (array[i] == '\n') {
+                in_comment = false;
             }
-            if (stack.empty()) {
-                return true;
+        } else if (in_string) {
+            if (array[i] == '\\') {
+                i++;
+            } else if (array[i] == '\"') {
+                in_string = false;
+            }
+        } else if (array[i] == '#' && !open.empty()) {
+            in_comment = true;
+        } else if (array[i] == '\"') {
+            in_string = true;
+        } else if (array[i] == '[') {
+            if (counts != nullptr) {
+                open.push_back(counts->size());
+                counts->push_back(1);
             } else {
+                open.push_back(0);
+            }
+        } else if (array[i] == ']') {
+            if (open.empty()) {
+                return false;
+            }
+            open.pop_back();
+            if (open.empty() && i + 1 != array.size()) {
                 return false;
             }
+        } else if (array[i] == ',' && counts != nullptr && !open.empty()) {
+            (*counts)[open.back()]++;
+        } else if (array[i] == ';') {
+            return false;
+        }
+    }
+    return open.empty() && !in_string && !in_comment;
+}
+
+namespace {
+
+    bool IsBlank(char c) {
+        return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+    }
+
+    std::string_view TrimLeft(std::string_view token) {
+        while (!token.empty() && IsBlank(token.front())) {
+            token.remove_prefix(1);
+        }
+        return token;
+    }
+
+    std::string_view Trim(std::string_view token) {
+        token = TrimLeft(token);
+        while (!token.empty() && IsBlank(token.back())) {
+            token.remove_suffix(1);
+        }
+        return token;
+    }
+
+    Variable* MakeScalar(std::string_view token) {
+        TYPE type = TypeVar(token);
+        if (type == STRING) {
+            std::string storage;
+            std::string_view text;
+            if (!DecodeString(token.substr(1, token.size() - 2), text, &storage)) {
+                return nullptr;
+            }
+            return new StringVar(text.data() == storage.data() ? std::move(storage) : std::string(text));
+        }
+        if (!omfl::CheckVarValue(token)) {
+            return nullptr;
         }
+        if (type == INT || type == FLOAT) {
+            if (token.front() == '+') {
+                token.remove_prefix(1);
+            }
+            if (type == INT) {
+                int value = 0;
+                auto result = std::from_chars(token.data(), token.data() + token.size(), value);
+                if (result.ec != std::errc() || result.ptr != token.data() + token.size()) {
+                    return nullptr;
+                }
+                return new IntVar(value);
+            }
+            float value = 0;
+            auto result = std::from_chars(token.data(), token.data() + token.size(), value);
+            if (result.ec != std::errc() || result.ptr != token.data() + token.size()) {
+                return nullptr;
+            }
+            return new FloatVar(value);
+        } else if (type == BOOL) {
+            return new BoolVar(token == "true");
+        }
+        return nullptr;
     }
+
+}// namespace
+
+void ArrayBuilder::Reset(const std::vector<size_t>* capacity_hints) {
+    stack_.clear();
+    carry_.clear();
+    capacity_hints_ = capacity_hints;
+    next_hint_ = 0;
+    in_string_ = false;
+    in_escape_ = false;
+    in_comment_ = false;
+    closed_child_ = false;
+    after_comma_ = false;
+    failed_ = false;
+    result_ = nullptr;
+    failure_ = INVALID_ARRAY;
+    fed_ = Position();
+    in_token_ = false;
+}
+
+bool ArrayBuilder::Charge(size_t bytes) {
+    if (nodes_left_ == 0) {
+        failure_ = TOO_MANY_NODES;
+        return false;
+    }
+    if (bytes > bytes_left_) {
+        failure_ = ARENA_EXHAUSTED;
+        return false;
+    }
+    nodes_left_--;
+    bytes_left_ -= bytes;
+    return true;
+}
+
+bool ArrayBuilder::FinishElement(std::string_view token, bool closing) {
+    token = Trim(token);
+    if (closed_child_) {
+        return token.empty();
+    }
+    if (token.empty()) {
+        return closing && !after_comma_;
+    }
+    if (!Charge(sizeof(StringVar) + token.size())) {
+        return false;
+    }
+    Variable* element = MakeScalar(token);
+    if (element == nullptr) {
+        return false;
+    }
+    stack_.back()->Append(element);
     return true;
 }
 
-Array* omfl::ParseArray(std::string array, Array* final_array) {
-    size_t quotes = 0;
-    size_t brackets = 0;
+size_t ArrayBuilder::Fail(size_t index, bool at_token) {
+    failed_ = true;
+    if (at_token && in_token_) {
+        failure_position_ = token_;
+    } else {
+        failure_position_ = {fed_.offset + index, fed_.line, fed_.line_start};
+    }
+    return index;
+}
+
+size_t ArrayBuilder::Feed(std::string_view chunk) {
     size_t start = 0;
-    std::string variable;
-    std::vector<Variable*> variables;
-    for (int i = 1; i < array.size() - 1; i++) {
-        if (array[i] == '[' && quotes % 2 == 0) {
-            brackets = brackets + 1;
-        } else if (array[i] == '\"' && brackets == 0) {
-            quotes = quotes + 1;
-        } else if (array[i] == ']' && quotes % 2 == 0) {
-            brackets = brackets - 1;
-        } else if ((array[i] == ',' && quotes % 2 == 0)) {
-            if (brackets == 0) {
-                variable = array.substr(start + 1, i - start - 1);
+    for (size_t i = 0; i < chunk.size(); i++) {
+        if (failed_ || result_ != nullptr) {
+            return i;
+        }
+        char c = chunk[i];
+        if (c == '\n') {
+            fed_.line++;
+            fed_.line_start = fed_.offset + i + 1;
+        }
+        if (in_comment_) {
+            if (c == '\n') {
+                in_comment_ = false;
                 start = i + 1;
-                if (TypeVar(variable) == INT && variable.size() != 0) {
-                    IntVar* int_var = new IntVar(std::stoi(variable));
-                    variables.push_back(int_var);
-                } else if (TypeVar(variable) == STRING) {
-                    StringVar* string_var = new StringVar(variable.substr(1, variable.size() - 2));
-                    variables.push_back(string_var);
-                } else if (TypeVar(variable) == BOOL) {
-                    if (variable == "true") {
-                        BoolVar* bool_var = new BoolVar(true);
-                        variables.push_back(bool_var);
-                    } else {
-                        BoolVar* bool_var = new BoolVar(false);
-                        variables.push_back(bool_var);
-                    }
-                } else if (TypeVar(variable) == FLOAT) {
-                    FloatVar* float_var = new FloatVar(std::stof(variable));
-                    variables.push_back(float_var);
-                } else if (TypeVar(variable) == ARRAY) {
-                    Array* array1 = new Array();
-                    Array* new_array = ParseArray(variable, array1);
-                    variables.push_back(new_array);
+            }
+            continue;
+        }
+        if (stack_.empty()) {
+            if (c != '[') {
+                return Fail(i, false);
+            }
+        } else if (in_string_) {
+            if (in_escape_) {
+                in_escape_ = false;
+            } else if (c == '\\') {
+                in_escape_ = true;
+            } else if (c == '\"') {
+                in_string_ = false;
+            }
+            continue;
+        }
+        if (!in_token_ && !IsBlank(c) && c != '#' && c != '[' && c != ',' && c != ']') {
+            token_ = {fed_.offset + i, fed_.line, fed_.line_start};
+            in_token_ = true;
+        }
+        if (c == '\"') {
+            in_string_ = true;
+        } else if (c == '#') {
+            std::string_view part = chunk.substr(start, i - start);
+            carry_.append(carry_.empty() ? TrimLeft(part) : part);
+            in_comment_ = true;
+        } else if (c == '[') {
+            if (!stack_.empty() && (closed_child_ || !Trim(chunk.substr(start, i - start)).empty() ||
+                                    !carry_.empty())) {
+                return Fail(i, false);
+            }
+            if (stack_.size() >= max_depth_) {
+                failure_ = ARRAY_TOO_DEEP;
+                return Fail(i, false);
+            }
+            if (!Charge(sizeof(Array))) {
+                return Fail(i, false);
+            }
+            Array* array = new Array();
+            if (capacity_hints_ != nullptr && next_hint_ < capacity_hints_->size()) {
+                array->Reserve((*capacity_hints_)[next_hint_++]);
+            }
+            stack_.push_back(array);
+            closed_child_ = false;
+            after_comma_ = false;
+            start = i + 1;
+        } else if (c == ',' || c == ']') {
+            std::string_view token = chunk.substr(start, i - start);
+            if (!carry_.empty()) {
+                carry_.append(token);
+                token = carry_;
+            }
+            if (!FinishElement(token, c == ']')) {
+                return Fail(i, true);
+            }
+            carry_.clear();
+            in_token_ = false;
+            start = i + 1;
+            if (c == ',') {
+                closed_child_ = false;
+                after_comma_ = true;
+            } else {
+                Array* array = stack_.back();
+                stack_.pop_back();
+                if (stack_.empty()) {
+                    result_ = array;
+                    return i + 1;
                 }
+                stack_.back()->Append(array);
+                closed_child_ = true;
+                after_comma_ = false;
             }
         }
     }
-    variable = array.substr(start + 1, array.size() - start - 2);
-    if (TypeVar(variable) == INT && variable.size() != 0) {
-        IntVar* int_var = new IntVar(std::stoi(variable));
-        variables.push_back(int_var);
-    } else if (TypeVar(variable) == STRING) {
-        StringVar* string_var = new StringVar(variable.substr(1, variable.size() - 2));
-        variables.push_back(string_var);
-    } else if (TypeVar(variable) == BOOL) {
-        if (variable == "true") {
-            BoolVar* bool_var = new BoolVar(true);
-            variables.push_back(bool_var);
-        } else {
-            BoolVar* bool_var = new BoolVar(false);
-            variables.push_back(bool_var);
+    if (!stack_.empty() && !in_comment_ && start < chunk.size()) {
+        std::string_view rest = chunk.substr(start);
+        carry_.append(carry_.empty() ? TrimLeft(rest) : rest);
+    }
+    fed_.offset += chunk.size();
+    return chunk.size();
+}
+
+Array* ArrayBuilder::Release() {
+    Array* result = result_;
+    result_ = nullptr;
+    return result;
+}
+
+Query::Query(Section* root, std::string_view pattern) : root_(root) {
+    if (!pattern.empty() && pattern.back() == '.') {
+        throw std::invalid_argument("Invalid argument");
+    }
+    size_t start = 0;
+    while (start < pattern.size()) {
+        size_t dot = std::min(pattern.find('.', start), pattern.size());
+        std::string_view segment = pattern.substr(start, dot - start);
+        if (segment.empty()) {
+            throw std::invalid_argument("Invalid argument");
+        }
+        // "**.**" matches the same paths as "**".
+        if (segment != "**" || segments_.empty() || segments_.back() != "**") {
+            segments_.emplace_back(segment);
         }
-    } else if (TypeVar(variable) == FLOAT) {
-        FloatVar* float_var = new FloatVar(std::stof(variable));
-        variables.push_back(float_var);
-    } else if (TypeVar(variable) == ARRAY) {
-        Array* array1 = new Array();
-        Array* new_array = ParseArray(variable, array1);
-        variables.push_back(new_array);
+        start = dot + 1;
+    }
+    if (segments_.size() >= 64) {
+        throw std::invalid_argument("Invalid argument");
     }
-    final_array = new Array(variables);
-    return final_array;
 }
 
-Parser omfl::parse(const std::string& str) {
-    Parser* parser = new Parser();
-    Section* current_section = &parser->Global();
-    std::istringstream file_stream(str);
-    std::string line_value;
-    while (std::getline(file_stream, line_value, '\n')) {
-        DeleteWhiteSpaces(line_value);
-        if (CheckElement(line_value) == EMPTY || CheckElement(line_value) == COMMENT) {
+uint64_t Query::Closure(uint64_t mask) const {
+    for (size_t i = 0; i < segments_.size(); i++) {
+        if ((mask >> i & 1) != 0 && segments_[i] == "**") {
+            mask |= uint64_t(1) << (i + 1);
+        }
+    }
+    return mask;
+}
+
+uint64_t Query::Step(uint64_t mask, const std::string& name) const {
+    uint64_t next = 0;
+    for (size_t i = 0; i < segments_.size(); i++) {
+        if ((mask >> i & 1) == 0) {
+            continue;
+        }
+        if (segments_[i] == "**") {
+            next |= uint64_t(1) << i;
+        } else if (segments_[i] == "*" || segments_[i] == name) {
+            next |= uint64_t(1) << (i + 1);
+        }
+    }
+    return Closure(next);
+}
+
+const std::string* Query::Literal(uint64_t mask) const {
+    mask &= ~(uint64_t(1) << segments_.size());
+    if (mask == 0 || (mask & (mask - 1)) != 0) {
+        return nullptr;
+    }
+    size_t i = 0;
+    while ((mask >> i & 1) == 0) {
+        i++;
+    }
+    if (segments_[i] == "*" || segments_[i] == "**") {
+        return nullptr;
+    }
+    return &segments_[i];
+}
+
+Query::Iterator::Iterator(const Query* query) : query_(query) {
+    if (!query->segments_.empty()) {
+        stack_.push_back({query->root_, query->Closure(1), 0, 0});
+    }
+    Advance();
+}
+
+bool Query::Iterator::NextVariable(Frame& frame) {
+    std::vector<Variable*>& variables = frame.section->GetArr();
+    if (const std::string* name = query_->Literal(frame.mask)) {
+        Variable* variable = frame.next_var == 0 ? frame.section->FindVar(*name) : nullptr;
+        frame.next_var = SIZE_MAX;
+        if (variable != nullptr && query_->Accepts(query_->Step(frame.mask, *name))) {
+            current_ = {frame.section, variable};
+            return true;
+        }
+        return false;
+    }
+    while (frame.next_var < variables.size()) {
+        Variable* variable = variables[frame.next_var++];
+        if (query_->Accepts(query_->Step(frame.mask, variable->GetName()))) {
+            current_ = {frame.section, variable};
+            return true;
+        }
+    }
+    return false;
+}
+
+Section* Query::Iterator::NextChild(Frame& frame, uint64_t& mask) {
+    std::vector<Section*>& children = frame.section->GetSectionChild();
+    if (const std::string* name = query_->Literal(frame.mask)) {
+        Section* child = frame.next_child == 0 ? frame.section->FindChild(*name) : nullptr;
+        frame.next_child = SIZE_MAX;
+        if (child != nullptr) {
+            mask = query_->Step(frame.mask, *name);
+        }
+        return child;
+    }
+    while (frame.next_child < children.size()) {
+        Section* child = children[frame.next_child++];
+        mask = query_->Step(frame.mask, child->GetName());
+        if (mask != 0) {
+            return child;
+        }
+    }
+    return nullptr;
+}
+
+void Query::Iterator::Advance() {
+    while (!stack_.empty()) {
+        if (NextVariable(stack_.back())) {
+            return;
+        }
+        uint64_t mask = 0;
+        if (Section* child = NextChild(stack_.back(), mask)) {
+            stack_.push_back({child, mask, 0, 0});
+            if (query_->Accepts(mask)) {
+                current_ = {child, nullptr};
+                return;
+            }
             continue;
-        } else if (CheckElement(line_value) == UNKNOWN) {
-            parser->SetValid();
-            return *parser;
-        } else if (CheckElement(line_value) == VARIABLE) {
-            TakeToStr(line_value);
-            std::pair<std::string, std::string> current_var = ParseVar(line_value);
-            if (!CheckVarName(current_var.first) || !CheckVarValue(current_var.second)) {
-                parser->SetValid();
-                return *parser;
+        }
+        stack_.pop_back();
+    }
+    query_ = nullptr;
+    current_ = Match();
+}
+
+Array* omfl::ParseArray(std::string_view array) {
+    std::vector<size_t> capacity_hints;
+    if (!CountArrayElements(array, &capacity_hints)) {
+        return nullptr;
+    }
+    ArrayBuilder builder;
+    builder.Reset(&capacity_hints);
+    if (builder.Feed(array) != array.size() || !builder.Done()) {
+        return nullptr;
+    }
+    return builder.Release();
+}
+
+namespace {
+
+    const size_t kArrayChunkSize = 4096;
+
+    class ViewBuffer : public std::streambuf {
+    public:
+        explicit ViewBuffer(std::string_view data) {
+            char* begin = const_cast<char*>(data.data());
+            setg(begin, begin, begin + data.size());
+        }
+    };
+
+    // Read position in the input, with the byte and line-length limits of
+    // the current parse. Every character is consumed through Next().
+    struct Cursor {
+        uint64_t offset = 0;
+        uint64_t line_start = 0;
+        uint32_t line = 0;
+        uint64_t max_offset = UINT64_MAX;
+        size_t max_line_length = SIZE_MAX;
+        bool truncated = false;
+        bool long_line = false;
+    };
+
+    int Next(std::streambuf& buffer, Cursor& cursor) {
+        const int eof = std::streambuf::traits_type::eof();
+        if (cursor.offset >= cursor.max_offset) {
+            cursor.truncated = buffer.sgetc() != eof;
+            return eof;
+        }
+        if (cursor.offset - cursor.line_start >= cursor.max_line_length) {
+            cursor.long_line = buffer.sgetc() != eof && buffer.sgetc() != '\n';
+            if (cursor.long_line) {
+                return eof;
+            }
+        }
+        int c = buffer.sbumpc();
+        if (c != eof) {
+            cursor.offset++;
+        }
+        return c;
+    }
+
+    bool Stopped(const Cursor& cursor) {
+        return cursor.truncated || cursor.long_line;
+    }
+
+    void Report(Parser& parser, uint64_t offset, uint32_t line, uint64_t line_start, DIAGNOSTIC kind) {
+        parser.AddDiagnostic({offset, line, static_cast<uint32_t>(offset - line_start + 1), kind});
+    }
+
+    void Report(Parser& parser, const Cursor& cursor, uint64_t offset, DIAGNOSTIC kind) {
+        Report(parser, offset, cursor.line, cursor.line_start, kind);
+    }
+
+    // Reads one physical line. When the line is a variable whose value opens
+    // an array, reading stops right after the '[' so that the elements can be
+    // streamed into the array instead of being buffered as part of the line.
+    bool ReadLine(std::streambuf& buffer, Cursor& cursor, std::string& line, bool& array_value) {
+        line.clear();
+        array_value = false;
+        cursor.line++;
+        cursor.line_start = cursor.offset;
+        bool after_equals = false;
+        bool plain = true;
+        int c;
+        while ((c = Next(buffer, cursor)) != std::streambuf::traits_type::eof()) {
+            if (c == '\n') {
+                return true;
+            }
+            line.push_back(static_cast<char>(c));
+            if (!plain || c == ' ' || c == '\t') {
+                continue;
+            }
+            if (c == '[' && after_equals) {
+                array_value = true;
+                return true;
+            } else if (c == '=' && !after_equals) {
+                after_equals = true;
+            } else if (after_equals || c == '#' || c == '[') {
+                plain = false;
+            }
+        }
+        return !line.empty();
+    }
+
+    void SkipLine(std::streambuf& buffer, Cursor& cursor) {
+        int c;
+        while ((c = Next(buffer, cursor)) != std::streambuf::traits_type::eof()) {
+            if (c == '\n') {
+                return;
+            }
+        }
+    }
+
+    // Consumes the rest of an array that failed to build: `rest` is the
+    // unparsed remainder of the current chunk, starting `depth` arrays deep.
+    // Input is dropped up to the end of the line on which the outermost array
+    // closes, or up to the end of the input, so the remaining lines of the
+    // array are not read as lines of their own.
+    void SkipArray(std::streambuf& buffer, Cursor& cursor, std::string_view rest, uint64_t rest_offset,
+                   size_t depth) {
+        bool in_string = false;
+        bool in_escape = false;
+        bool in_comment = false;
+        size_t used = 0;
+        while (depth > 0) {
+            int c;
+            uint64_t next_offset;
+            if (used < rest.size()) {
+                c = static_cast<unsigned char>(rest[used++]);
+                next_offset = rest_offset + used;
+            } else if ((c = Next(buffer, cursor)) != std::streambuf::traits_type::eof()) {
+                next_offset = cursor.offset;
             } else {
-                if (TypeVar(current_var.second) == INT) {
-                    for (int i = 0; i < current_section->GetArr().size(); i++) {
-                        if (current_section->GetArr()[i]->GetName() == current_var.first) {
-                            parser->SetValid();
-                            return *parser;
-                        }
+                return;
+            }
+            if (c == '\n') {
+                in_comment = false;
+                cursor.line++;
+                cursor.line_start = next_offset;
+            } else if (in_comment) {
+                continue;
+            } else if (in_string) {
+                if (in_escape) {
+                    in_escape = false;
+                } else if (c == '\\') {
+                    in_escape = true;
+                } else if (c == '\"') {
+                    in_string = false;
+                }
+            } else if (c == '\"') {
+                in_string = true;
+            } else if (c == '#') {
+                in_comment = true;
+            } else if (c == '[') {
+                depth++;
+            } else if (c == ']') {
+                depth--;
+            }
+        }
+        if (used == rest.size() || rest.back() != '\n') {
+            SkipLine(buffer, cursor);
+        }
+    }
+
+    // Feeds the rest of an array value to the builder chunk by chunk, across
+    // as many physical lines as it spans. Only text after the closing ']' on
+    // the last line is kept, and it must be blank or a comment. On failure
+    // the start of the rejected element is reported and the rest of the
+    // array skipped.
+    Array* StreamArray(std::streambuf& buffer, Cursor& cursor, Parser& parser, ArrayBuilder& builder,
+                       std::string& chunk) {
+        // The builder counts from the '[' that ReadLine stopped after.
+        uint64_t array_offset = cursor.offset - 1;
+        uint32_t array_line = cursor.line;
+        uint64_t array_line_start = cursor.line_start;
+        builder.Reset();
+        builder.Feed("[");
+        size_t used = 0;
+        int c = 0;
+        while (!builder.Done()) {
+            uint64_t chunk_offset = cursor.offset;
+            chunk.clear();
+            while (chunk.size() < kArrayChunkSize && (c = Next(buffer, cursor)) != std::streambuf::traits_type::eof()) {
+                chunk.push_back(static_cast<char>(c));
+                if (c == '\n') {
+                    break;
+                }
+            }
+            if (chunk.empty()) {
+                if (!Stopped(cursor)) {
+                    Report(parser, cursor, cursor.offset, INVALID_ARRAY);
+                }
+                return nullptr;
+            }
+            used = builder.Feed(chunk);
+            if (builder.Failed()) {
+                const ArrayBuilder::Position& position = builder.FailurePosition();
+                Report(parser, array_offset + position.offset, array_line + static_cast<uint32_t>(position.line),
+                       position.line == 0 ? array_line_start : array_offset + position.line_start,
+                       builder.Failure());
+                if (builder.Failure() == INVALID_ARRAY) {
+                    SkipArray(buffer, cursor, std::string_view(chunk).substr(used), chunk_offset + used,
+                              builder.Depth());
+                }
+                return nullptr;
+            }
+            if (!builder.Done() && chunk.back() == '\n') {
+                cursor.line++;
+                cursor.line_start = cursor.offset;
+            }
+        }
+        uint64_t tail_offset = cursor.offset - (chunk.size() - used);
+        chunk.erase(0, used);
+        while (!chunk.empty() && chunk.back() != '\n' &&
+               (c = Next(buffer, cursor)) != std::streambuf::traits_type::eof()) {
+            chunk.push_back(static_cast<char>(c));
+        }
+        if (!chunk.empty() && chunk.back() == '\n') {
+            chunk.pop_back();
+        }
+        std::string_view tail = Trim(chunk);
+        if (!tail.empty() && tail.front() != '#') {
+            Report(parser, cursor, tail_offset + (tail.data() - chunk.data()), INVALID_ARRAY);
+            return nullptr;
+        }
+        return builder.Release();
+    }
+
+    size_t SkipBlanks(const std::string& line, size_t index) {
+        while (index < line.size() && (line[index] == ' ' || line[index] == '\t')) {
+            index++;
+        }
+        return index;
+    }
+
+    bool IsLimit(DIAGNOSTIC kind) {
+        return kind >= INPUT_TOO_LARGE;
+    }
+
+}// namespace
+
+// Every problem is recorded as a Diagnostic and parsing resumes on the
+// next line, so a single pass reports all errors of a document. Crossing
+// one of the ParseOptions limits stops the parse instead.
+Parser ParserContext::Run(std::streambuf& buffer, const ParseOptions& options) {
+    Parser parser;
+    Section* current_section = &parser.Global();
+    Cursor cursor;
+    cursor.max_offset = options.max_bytes;
+    cursor.max_line_length = options.max_line_length;
+    size_t nodes_left = options.max_nodes;
+    size_t bytes_left = options.max_arena_bytes;
+    auto charge = [&](size_t bytes) {
+        if (nodes_left == 0 || bytes > bytes_left) {
+            Report(parser, cursor, cursor.line_start, nodes_left == 0 ? TOO_MANY_NODES : ARENA_EXHAUSTED);
+            return false;
+        }
+        nodes_left--;
+        bytes_left -= bytes;
+        return true;
+    };
+    bool array_value = false;
+    // A rejected line whose value opens an array drops the whole array, so
+    // that its remaining lines are not reported as lines of their own.
+    auto reject = [&](uint64_t offset, DIAGNOSTIC kind) {
+        Report(parser, cursor, offset, kind);
+        if (array_value) {
+            SkipArray(buffer, cursor, std::string_view(), cursor.offset, 1);
+        }
+    };
+    while (ReadLine(buffer, cursor, line_, array_value) && !Stopped(cursor)) {
+        uint64_t line_offset = cursor.line_start + SkipBlanks(line_, 0);
+        DeleteWhiteSpaces(line_);
+        ELEMENT element = line_.empty() || line_.front() == '#' ? COMMENT : CheckElement(line_);
+        if (element == EMPTY || element == COMMENT) {
+            continue;
+        } else if (element == UNKNOWN) {
+            reject(line_offset, UNKNOWN_LINE);
+        } else if (element == VARIABLE) {
+            uint64_t value_offset = line_offset + SkipBlanks(line_, line_.find('=') + 1);
+            if (line_.front() == '=') {
+                reject(line_offset, INVALID_NAME);
+                continue;
+            }
+            TakeToStr(line_);
+            size_t equals = line_.find('=');
+            if (equals == std::string::npos) {
+                reject(line_offset, UNKNOWN_LINE);
+                continue;
+            }
+            name_.assign(line_, 0, equals);
+            value_.assign(line_, equals + 1);
+            TYPE type = array_value ? ARRAY : TypeVar(value_);
+            std::string_view text;
+            DIAGNOSTIC error = UNKNOWN_LINE;
+            if (!CheckVarName(name_)) {
+                error = INVALID_NAME;
+            } else if (current_section->HasVar(name_)) {
+                error = DUPLICATE_KEY;
+            } else if (type == STRING) {
+                if (!DecodeString(std::string_view(value_).substr(1, value_.size() - 2), text, &text_)) {
+                    error = INVALID_VALUE;
+                }
+            } else if (type != ARRAY && !CheckVarValue(value_)) {
+                error = INVALID_VALUE;
+            }
+            if (error != UNKNOWN_LINE) {
+                reject(error == INVALID_VALUE ? value_offset : line_offset, error);
+                continue;
+            }
+            if (!charge(sizeof(StringVar) + name_.size() + value_.size())) {
+                return parser;
+            }
+            try {
+                if (type == INT) {
+                    current_section->AddNewIntVar(name_, std::stoi(value_));
+                } else if (type == STRING) {
+                    current_section->AddNewStringVar(name_, std::string(text));
+                } else if (type == BOOL) {
+                    current_section->AddNewBoolVar(name_, value_ == "true");
+                } else if (type == FLOAT) {
+                    current_section->AddNewFloatVar(name_, std::stof(value_));
+                } else if (type == ARRAY) {
+                    Array* array = nullptr;
+                    builder_.SetLimits(options.max_array_depth, nodes_left, bytes_left);
+                    if (array_value) {
+                        array = StreamArray(buffer, cursor, parser, builder_, chunk_);
+                    } else if ((array = ParseArray(value_)) == nullptr) {
+                        Report(parser, cursor, value_offset, INVALID_ARRAY);
                     }
-                    current_section->AddNewIntVar(current_var.first, std::stoi(current_var.second));
-                } else if (TypeVar(current_var.second) == STRING) {
-                    current_section->AddNewStringVar(current_var.first,
-                                                     current_var.second.substr(1, current_var.second.size() - 2));
-                } else if (TypeVar(current_var.second) == BOOL) {
-                    if (current_var.second == "true") {
-                        current_section->AddNewBoolVar(current_var.first, true);
-                    } else {
-                        current_section->AddNewBoolVar(current_var.first, false);
+                    nodes_left = builder_.NodesLeft();
+                    bytes_left = builder_.BytesLeft();
+                    if (array != nullptr) {
+                        current_section->AddNewArray(name_, *array);
+                    } else if (array_value && IsLimit(builder_.Failure())) {
+                        return parser;
                     }
-                } else if (TypeVar(current_var.second) == FLOAT) {
-                    current_section->AddNewFloatVar(current_var.first, std::stof(current_var.second));
-                } else if (TypeVar(current_var.second) == ARRAY) {
-                    Array* array = new Array();
-                    current_section->AddNewArray(current_var.first, *ParseArray(current_var.second, array));
                 }
+            } catch (const std::out_of_range&) {
+                Report(parser, cursor, value_offset, INVALID_VALUE);
             }
-        } else if (CheckElement(line_value) == SECTION) {
-            line_value = line_value.substr(1, line_value.size() - 2);
-            if (CheckSection(line_value)) {
-                std::istringstream section_stream(line_value);
-                std::string section_value;
-                std::vector<std::string> sections;
-                while (std::getline(section_stream, section_value, '.')) {
-                    sections.push_back(section_value);
-                }
-                Section* this_section = &parser->Global();
-                for (int i = 0; i < sections.size(); i++) {
-                    bool flag = false;
-                    for (int j = 0; j < parser->GetSectionList().size(); j++) {
-                        if (parser->GetSectionList()[j]->GetName() == sections[i]) {
-                            this_section = parser->GetSectionList()[j];
-                            flag = true;
-                            break;
+        } else if (element == SECTION) {
+            line_.erase(line_.size() - 1).erase(0, 1);
+            if (CheckSection(line_)) {
+                Section* this_section = &parser.Global();
+                size_t start = 0;
+                while (start < line_.size()) {
+                    size_t dot = std::min(line_.find('.', start), line_.size());
+                    name_.assign(line_, start, dot - start);
+                    start = dot + 1;
+                    Section* child = this_section->FindChild(name_);
+                    if (child == nullptr) {
+                        if (!charge(sizeof(Section) + name_.size())) {
+                            return parser;
                         }
+                        child = &parser.AddNewSection(name_, this_section);
                     }
-                    if (!flag) {
-                        this_section = &parser->AddNewSection(sections[i], this_section->GetName());
-                    }
+                    this_section = child;
                 }
                 current_section = this_section;
             } else {
-                parser->SetValid();
-                return *parser;
+                Report(parser, cursor, line_offset, INVALID_SECTION);
+                discarded_ = Section();
+                current_section = &discarded_;
             }
         }
     }
-    return *parser;
+    if (cursor.truncated) {
+        Report(parser, cursor, cursor.offset, INPUT_TOO_LARGE);
+    } else if (cursor.long_line) {
+        Report(parser, cursor, cursor.offset, LINE_TOO_LONG);
+    }
+    return parser;
+}
+
+Parser ParserContext::Parse(std::string_view str, const ParseOptions& options) {
+    if (str.size() > options.max_bytes) {
+        Parser parser;
+        parser.AddDiagnostic({options.max_bytes, 0, 0, INPUT_TOO_LARGE});
+        return parser;
+    }
+    ViewBuffer buffer(str);
+    return Run(buffer, options);
+}
+
+Parser ParserContext::Parse(std::istream& stream, const ParseOptions& options) {
+    return Run(*stream.rdbuf(), options);
 }
 
+Parser ParserContext::Parse(const std::filesystem::path& path, const ParseOptions& options) {
+    std::filebuf file;
+    if (!file.open(path, std::ios::in | std::ios::binary)) {
+        Parser parser;
+        parser.AddDiagnostic({0, 0, 0, UNREADABLE_INPUT});
+        return parser;
+    }
+    return Run(file, options);
+}
+
+namespace {
 
+    ParserContext& ThreadContext() {
+        thread_local ParserContext context;
+        return context;
+    }
+
+}// namespace
 
+Parser omfl::parse(const std::string& str) {
+    return parse(str, ParseOptions());
+}
+
+Parser omfl::parse(std::istream& stream) {
+    return parse(stream, ParseOptions());
+}
+
+Parser omfl::parse(const std::filesystem::path& path) {
+    return parse(path, ParseOptions());
+}
+
+Parser omfl::parse(const std::string& str, const ParseOptions& options) {
+    return ThreadContext().Parse(str, options);
+}
+
+Parser omfl::parse(std::istream& stream, const ParseOptions& options) {
+    return ThreadContext().Parse(stream, options);
+}
+
+Parser omfl::parse(const std::filesystem::path& path, const ParseOptions& options) {
+    return ThreadContext().Parse(path, options);
+}
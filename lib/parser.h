@@ -5,9 +5,14 @@
 #include <utility>
 #include <vector>
 #include <algorithm>
+#include <cstdint>
+#include <cstddef>
 #include <sstream>
 #include <iostream>
+#include <iterator>
 #include <stack>
+#include <string_view>
+#include <unordered_map>
 
 
 namespace omfl {
@@ -29,13 +34,82 @@ namespace omfl {
         UNDEFINED
     };
 
+    enum DIAGNOSTIC {
+        UNKNOWN_LINE = 1,
+        INVALID_NAME,
+        INVALID_VALUE,
+        INVALID_ARRAY,
+        INVALID_SECTION,
+        DUPLICATE_KEY,
+        UNREADABLE_INPUT,
+        INPUT_TOO_LARGE,
+        LINE_TOO_LONG,
+        ARRAY_TOO_DEEP,
+        TOO_MANY_NODES,
+        ARENA_EXHAUSTED
+    };
+
+    // Line and column are 1-based, the offset counts bytes from the start of
+    // the input and points at the first character of the offending token.
+    struct Diagnostic {
+        uint64_t offset;
+        uint32_t line;
+        uint32_t column;
+        DIAGNOSTIC kind;
+    };
+
+    // Hard limits for parsing untrusted input. Crossing any of them records
+    // the matching diagnostic and stops the parse at that point. The arena
+    // limit bounds the bytes allocated for the tree: node objects, names and
+    // string values.
+    struct ParseOptions {
+        size_t max_bytes = SIZE_MAX;
+        size_t max_line_length = SIZE_MAX;
+        size_t max_array_depth = SIZE_MAX;
+        size_t max_nodes = SIZE_MAX;
+        size_t max_arena_bytes = SIZE_MAX;
+    };
+
+    // 128-bit content hash. Hashes of unordered collections are combined by
+    // lane-wise addition, so they can be updated in place when one member
+    // is added or removed.
+    struct Hash128 {
+        uint64_t low = 0;
+        uint64_t high = 0;
+
+        Hash128& operator+=(const Hash128& other) {
+            low += other.low;
+            high += other.high;
+            return *this;
+        }
+
+        Hash128& operator-=(const Hash128& other) {
+            low -= other.low;
+            high -= other.high;
+            return *this;
+        }
+
+        bool operator==(const Hash128& other) const {
+            return low == other.low && high == other.high;
+        }
+
+        bool operator!=(const Hash128& other) const {
+            return !(*this == other);
+        }
+    };
+
     class Variable;
 
+    class Footprint;
+
     class Element {
     protected:
         std::string name_;
         ELEMENT type_element;
 
+        friend class Footprint;
+        friend class Section;
+
     public:
         std::string GetName();
 
@@ -74,11 +148,11 @@ namespace omfl {
 
     class Variable : public Element {
     protected:
-        std::string name_ = "variable";
-
         TYPE type_ = UNDEFINED;
 
-        Variable() = default;
+        Variable() {
+            name_ = "variable";
+        }
 
         virtual ~Variable() = default;
 
@@ -182,6 +256,8 @@ namespace omfl {
     class StringVar : public Variable {
     protected:
         std::string value_;
+
+        friend class Footprint;
     public:
         explicit StringVar(std::string value) {
             value_ = std::move(value);
@@ -272,6 +348,8 @@ namespace omfl {
     class Array : public Variable {
     protected:
         std::vector<Variable*> var_array;
+
+        friend class Footprint;
     public:
         Array() {
             type_ = ARRAY;
@@ -290,6 +368,14 @@ namespace omfl {
             type_element = VARIABLE;
         }
 
+        // Copies share the elements of `other`.
+        Array(const Array& other) {
+            name_ = other.name_;
+            var_array = other.var_array;
+            type_ = ARRAY;
+            type_element = VARIABLE;
+        }
+
         Array& operator=(Array const& other) {
             name_ = other.name_;
             var_array = other.var_array;
@@ -298,6 +384,18 @@ namespace omfl {
             return *this;
         }
 
+        void Reserve(size_t size) {
+            var_array.reserve(size);
+        }
+
+        void Append(Variable* element) {
+            var_array.push_back(element);
+        }
+
+        [[nodiscard]] size_t Size() const {
+            return var_array.size();
+        }
+
         Variable& operator[](int index) {
             if (index >= var_array.size()) {
                 BoolVar* new_var = new BoolVar(false);
@@ -308,16 +406,114 @@ namespace omfl {
         }
     };
 
+    class ArrayBuilder {
+    public:
+        // A place in the text fed since the last Reset(): the byte offset,
+        // the number of line breaks before it and the offset at which its
+        // line starts.
+        struct Position {
+            uint64_t offset = 0;
+            size_t line = 0;
+            uint64_t line_start = 0;
+        };
+
+    private:
+        std::vector<Array*> stack_;
+        std::string carry_;
+        const std::vector<size_t>* capacity_hints_ = nullptr;
+        size_t next_hint_ = 0;
+        bool in_string_ = false;
+        bool in_escape_ = false;
+        bool in_comment_ = false;
+        bool closed_child_ = false;
+        bool after_comma_ = false;
+        bool failed_ = false;
+        Array* result_ = nullptr;
+        size_t max_depth_ = SIZE_MAX;
+        size_t nodes_left_ = SIZE_MAX;
+        size_t bytes_left_ = SIZE_MAX;
+        DIAGNOSTIC failure_ = INVALID_ARRAY;
+        Position fed_;
+        Position token_;
+        bool in_token_ = false;
+        Position failure_position_;
+
+        bool Charge(size_t bytes);
+
+        size_t Fail(size_t index, bool at_token);
+
+        bool FinishElement(std::string_view token, bool closing);
+
+    public:
+        void Reset(const std::vector<size_t>* capacity_hints = nullptr);
+
+        // Limits the nesting depth and the number and size of the nodes
+        // created until the next call; exceeding them fails the build with
+        // the matching Failure().
+        void SetLimits(size_t max_depth, size_t nodes, size_t bytes) {
+            max_depth_ = max_depth;
+            nodes_left_ = nodes;
+            bytes_left_ = bytes;
+        }
+
+        [[nodiscard]] size_t NodesLeft() const {
+            return nodes_left_;
+        }
+
+        [[nodiscard]] size_t BytesLeft() const {
+            return bytes_left_;
+        }
+
+        [[nodiscard]] DIAGNOSTIC Failure() const {
+            return failure_;
+        }
+
+        // Start of the rejected element after a failed build, or the bracket
+        // or separator that was rejected when there is no element.
+        [[nodiscard]] const Position& FailurePosition() const {
+            return failure_position_;
+        }
+
+        size_t Feed(std::string_view chunk);
+
+        [[nodiscard]] bool Done() const {
+            return result_ != nullptr;
+        }
+
+        [[nodiscard]] bool Failed() const {
+            return failed_;
+        }
+
+        // Arrays still open, i.e. the nesting level at the failure point
+        // after a failed build.
+        [[nodiscard]] size_t Depth() const {
+            return stack_.size();
+        }
+
+        Array* Release();
+    };
 
     class Section : public Element {
-        std::string name_ = "global";
+        // The indexes are keyed by views of the names of the nodes they point
+        // to, so a node's name must not change while it is indexed.
         std::vector<Variable*> var_list;
+        std::unordered_map<std::string_view, Variable*> var_index;
         Section* parent_section = nullptr;
         std::vector<Section*> child_section;
+        std::unordered_map<std::string_view, Section*> child_index;
+        Hash128 hash_;
+
+        void AddVar(Variable* variable);
+
+        void RebuildIndexes();
+
+        friend class Footprint;
     public:
-        Section() = default;
+        Section() {
+            name_ = "global";
+        }
 
-        std::string GetName() {
+        [[nodiscard]] std::string GetName() const {
             return name_;
         }
 
@@ -332,30 +528,89 @@ namespace omfl {
             type_element = SECTION;
         }
 
+        // Copies share the variables and child sections of `other`; the
+        // indexes are rebuilt to view the names of those nodes.
+        Section(const Section& other) {
+            name_ = other.name_;
+            var_list = other.var_list;
+            parent_section = other.parent_section;
+            child_section = other.child_section;
+            hash_ = other.hash_;
+            type_element = SECTION;
+            RebuildIndexes();
+        }
+
         Element& Get(std::string name_variable);
 
         std::vector<Section*>& GetSectionChild() {
             return child_section;
         }
 
+        [[nodiscard]] const std::vector<Section*>& GetSectionChild() const {
+            return child_section;
+        }
+
         Section& operator=(const Section& other) {
             name_ = other.name_;
             var_list = other.var_list;
             parent_section = other.parent_section;
             child_section = other.child_section;
+            hash_ = other.hash_;
             type_element = SECTION;
+            RebuildIndexes();
             return *this;
         }
 
         Section& SetChild(Section* child) {
+            child_index.emplace(child->name_, child);
             child_section.push_back(child);
             return *child_section.back();
         }
 
+        void ReplaceChild(Section* old_child, Section* new_child);
+
         std::vector<Variable*>& GetArr() {
             return var_list;
         }
 
+        [[nodiscard]] const std::vector<Variable*>& GetArr() const {
+            return var_list;
+        }
+
+        // Sum of HashVariable over the variables of this section, kept up
+        // to date by every method that adds, replaces or removes one.
+        [[nodiscard]] const Hash128& LocalHash() const {
+            return hash_;
+        }
+
+        [[nodiscard]] bool HasVar(const std::string& name) const {
+            return var_index.find(name) != var_index.end();
+        }
+
+        [[nodiscard]] Variable* FindVar(const std::string& name) const {
+            auto it = var_index.find(name);
+            if (it == var_index.end()) {
+                return nullptr;
+            }
+            return it->second;
+        }
+
+        [[nodiscard]] Section* FindChild(const std::string& name) const {
+            auto it = child_index.find(name);
+            if (it == child_index.end()) {
+                return nullptr;
+            }
+            return it->second;
+        }
+
+        void SetVar(Variable* variable);
+
+        bool RemoveVar(const std::string& name);
+
+        bool RemoveChild(const std::string& name);
+
+        // The AddNew* methods throw std::invalid_argument when the section
+        // already has a variable with that name.
         void AddNewIntVar(std::string& name, int value);
 
         void AddNewStringVar(std::string& name, std::string value);
@@ -368,17 +623,137 @@ namespace omfl {
     };
 
 
+    // A query result: a section, or a variable together with the section
+    // that holds it.
+    struct Match {
+        Section* section = nullptr;
+        Variable* variable = nullptr;
+    };
+
+    // Lazy depth-first walk over the sections and variables whose dotted path
+    // matches a pattern such as "servers.*.ip". A pattern segment is a name,
+    // '*' for exactly one segment or '**' for any number of segments. Names
+    // are looked up through the child and variable indexes, so only branches
+    // that can still match are visited. Results come in document order,
+    // sections before their contents; iterators are invalidated by changes
+    // to the tree.
+    class Query {
+        std::vector<std::string> segments_;
+        Section* root_ = nullptr;
+
+        // Sets of pattern positions still to be matched are kept as bit
+        // masks; bit segments_.size() means the whole pattern matched.
+        [[nodiscard]] uint64_t Closure(uint64_t mask) const;
+
+        [[nodiscard]] uint64_t Step(uint64_t mask, const std::string& name) const;
+
+        [[nodiscard]] bool Accepts(uint64_t mask) const {
+            return (mask >> segments_.size() & 1) != 0;
+        }
+
+        [[nodiscard]] const std::string* Literal(uint64_t mask) const;
+
+    public:
+        class Iterator {
+            struct Frame {
+                Section* section;
+                uint64_t mask;
+                size_t next_var;
+                size_t next_child;
+            };
+
+            const Query* query_ = nullptr;
+            std::vector<Frame> stack_;
+            Match current_;
+
+            bool NextVariable(Frame& frame);
+
+            Section* NextChild(Frame& frame, uint64_t& mask);
+
+            void Advance();
+
+        public:
+            using iterator_category = std::input_iterator_tag;
+            using value_type = Match;
+            using difference_type = std::ptrdiff_t;
+            using pointer = const Match*;
+            using reference = const Match&;
+
+            Iterator() = default;
+
+            explicit Iterator(const Query* query);
+
+            const Match& operator*() const {
+                return current_;
+            }
+
+            const Match* operator->() const {
+                return &current_;
+            }
+
+            Iterator& operator++() {
+                Advance();
+                return *this;
+            }
+
+            bool operator==(const Iterator& other) const {
+                return query_ == other.query_ && current_.section == other.current_.section &&
+                       current_.variable == other.current_.variable;
+            }
+
+            bool operator!=(const Iterator& other) const {
+                return !(*this == other);
+            }
+        };
+
+        Query(Section* root, std::string_view pattern);
+
+        [[nodiscard]] Iterator begin() const {
+            return Iterator(this);
+        }
+
+        [[nodiscard]] Iterator end() const {
+            return Iterator();
+        }
+    };
+
     class Parser {
         std::string name;
         Section global_section = Section();
         std::vector<Section*> section_list = {&global_section};
         bool is_valid = true;
         std::string path_;
+        std::vector<Diagnostic> diagnostics;
+
+        friend class Editor;
+        friend class Footprint;
+
     public:
         Parser() {
             name = "my new parser";
         }
 
+        Parser(const Parser& other)
+            : name(other.name),
+              global_section(other.global_section),
+              section_list(other.section_list),
+              is_valid(other.is_valid),
+              path_(other.path_),
+              diagnostics(other.diagnostics) {
+            section_list[0] = &global_section;
+        }
+
+        Parser& operator=(const Parser& other) {
+            name = other.name;
+            global_section = other.global_section;
+            section_list = other.section_list;
+            section_list[0] = &global_section;
+            is_valid = other.is_valid;
+            path_ = other.path_;
+            diagnostics = other.diagnostics;
+            return *this;
+        }
+
         [[nodiscard]] std::vector<Section*> GetSectionList() const {
             return this->section_list;
         }
@@ -391,14 +766,48 @@ namespace omfl {
             return global_section;
         }
 
+        [[nodiscard]] const Section& Global() const {
+            return global_section;
+        }
+
         Section& AddNewSection(std::string& name, std::string parent_name);
 
+        Section& AddNewSection(const std::string& name, Section* parent);
+
+        // Recomputes section_list after sections were attached directly
+        // through Section::SetChild.
+        void RebuildSectionList();
+
         [[nodiscard]] Element& Get(std::string name_variable) const;
 
+        [[nodiscard]] Query Find(std::string_view pattern) const {
+            return Query(const_cast<Section*>(&global_section), pattern);
+        }
+
+        // Calls visit(const Match&) for every section and variable below the
+        // section at prefix, which may itself contain wildcards.
+        template <typename Visitor>
+        void ForEachUnder(std::string_view prefix, Visitor visit) const {
+            std::string pattern(prefix);
+            pattern += pattern.empty() ? "*.**" : ".*.**";
+            for (const Match& match : Find(pattern)) {
+                visit(match);
+            }
+        }
+
         void SetValid() {
             this->is_valid = false;
         }
 
+        void AddDiagnostic(const Diagnostic& diagnostic) {
+            diagnostics.push_back(diagnostic);
+            is_valid = false;
+        }
+
+        [[nodiscard]] const std::vector<Diagnostic>& GetDiagnostics() const {
+            return diagnostics;
+        }
+
         void SetPath(const std::string& path){
             path_ = path;
         }
@@ -408,25 +817,201 @@ namespace omfl {
         }
     };
 
+    // Scratch state kept between parses: line and chunk buffers, the array
+    // builder stack, the token strings and the buffer for decoded escapes.
+    // Parsing many small documents with one context reuses their capacity
+    // instead of allocating it again for every document. A context must not
+    // be shared between threads; the free parse() functions use one per
+    // thread.
+    class ParserContext {
+        std::string line_;
+        std::string chunk_;
+        std::string name_;
+        std::string value_;
+        std::string text_;
+        ArrayBuilder builder_;
+        Section discarded_;
+
+        Parser Run(std::streambuf& buffer, const ParseOptions& options);
+
+    public:
+        Parser Parse(std::string_view str, const ParseOptions& options = ParseOptions());
+
+        Parser Parse(const std::string& str, const ParseOptions& options = ParseOptions()) {
+            return Parse(std::string_view(str), options);
+        }
+
+        Parser Parse(std::istream& stream, const ParseOptions& options = ParseOptions());
+
+        Parser Parse(const std::filesystem::path& path, const ParseOptions& options = ParseOptions());
+    };
+
+    // Hash of a variable's name, type and value; array elements are hashed
+    // in order.
+    Hash128 HashVariable(Variable* variable);
+
+    // Hash of a child section entry: its name and the hash of its contents.
+    Hash128 HashSectionEntry(const std::string& name, const Hash128& contents);
+
     void TakeToStr(std::string& line);
 
     void DeleteWhiteSpaces(std::string& line);
 
-    std::pair<std::string, std::string> ParseVar(std::string current_var);
+    std::pair<std::string, std::string> ParseVar(const std::string& current_var);
 
-    ELEMENT CheckElement(std::string current_line);
+    ELEMENT CheckElement(const std::string& current_line);
 
     Parser parse(const std::filesystem::path& path);
 
     Parser parse(const std::string& str);
 
-    bool CheckVarName(std::string var_name);
+    Parser parse(std::istream& stream);
+
+    Parser parse(const std::filesystem::path& path, const ParseOptions& options);
+
+    Parser parse(const std::string& str, const ParseOptions& options);
+
+    Parser parse(std::istream& stream, const ParseOptions& options);
+
+    bool CheckVarName(const std::string& var_name);
+
+    bool CheckVarValue(std::string_view var_value);
 
-    bool CheckVarValue(std::string var_value);
+    TYPE TypeVar(std::string_view line_value);
+
+    bool CountArrayElements(std::string_view array, std::vector<size_t>* counts);
+
+    Array* ParseArray(std::string_view array);
+
+    // Length of the well-formed UTF-8 sequence starting at bytes[at], or 0
+    // when it is truncated, overlong, a surrogate or above U+10FFFF.
+    constexpr size_t Utf8SequenceLength(std::string_view bytes, size_t at) {
+        unsigned char lead = static_cast<unsigned char>(bytes[at]);
+        if (lead < 0x80) {
+            return 1;
+        }
+        size_t length = 0;
+        unsigned char low = 0x80;
+        unsigned char high = 0xBF;
+        if (lead >= 0xC2 && lead <= 0xDF) {
+            length = 2;
+        } else if (lead >= 0xE0 && lead <= 0xEF) {
+            length = 3;
+            low = lead == 0xE0 ? 0xA0 : 0x80;
+            high = lead == 0xED ? 0x9F : 0xBF;
+        } else if (lead >= 0xF0 && lead <= 0xF4) {
+            length = 4;
+            low = lead == 0xF0 ? 0x90 : 0x80;
+            high = lead == 0xF4 ? 0x8F : 0xBF;
+        } else {
+            return 0;
+        }
+        if (bytes.size() - at < length) {
+            return 0;
+        }
+        for (size_t i = 1; i < length; i++) {
+            unsigned char next = static_cast<unsigned char>(bytes[at + i]);
+            if (next < (i == 1 ? low : 0x80) || next > (i == 1 ? high : 0xBF)) {
+                return 0;
+            }
+        }
+        return length;
+    }
+
+    // First '#' that is not inside a string literal.
+    constexpr size_t FindComment(std::string_view line) {
+        bool in_string = false;
+        for (size_t i = 0; i < line.size(); i++) {
+            if (in_string && line[i] == '\\') {
+                i++;
+            } else if (line[i] == '\"') {
+                in_string = !in_string;
+            } else if (line[i] == '#' && !in_string) {
+                return i;
+            }
+        }
+        return std::string_view::npos;
+    }
+
+    // Reads the four hex digits at text[at].
+    constexpr bool ReadHex(std::string_view text, size_t at, uint32_t& code) {
+        if (text.size() < at + 4) {
+            return false;
+        }
+        code = 0;
+        for (size_t i = at; i < at + 4; i++) {
+            char c = text[i];
+            if (c >= '0' && c <= '9') {
+                code = code * 16 + (c - '0');
+            } else if (c >= 'a' && c <= 'f') {
+                code = code * 16 + (c - 'a' + 10);
+            } else if (c >= 'A' && c <= 'F') {
+                code = code * 16 + (c - 'A' + 10);
+            } else {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Length of the escape sequence starting at body[at] == '\\', or 0 when
+    // it is unknown or malformed. `code` receives the code point it stands
+    // for; a \uXXXX high surrogate must be followed by an escaped low one.
+    constexpr size_t DecodeEscape(std::string_view body, size_t at, uint32_t& code) {
+        if (at + 1 >= body.size()) {
+            return 0;
+        }
+        switch (body[at + 1]) {
+            case '\"':
+            case '\\':
+            case '/':
+                code = static_cast<uint32_t>(body[at + 1]);
+                return 2;
+            case 'b':
+                code = '\b';
+                return 2;
+            case 'f':
+                code = '\f';
+                return 2;
+            case 'n':
+                code = '\n';
+                return 2;
+            case 'r':
+                code = '\r';
+                return 2;
+            case 't':
+                code = '\t';
+                return 2;
+            case 'u': {
+                if (!ReadHex(body, at + 2, code) || (code >= 0xDC00 && code <= 0xDFFF)) {
+                    return 0;
+                }
+                if (code < 0xD800 || code > 0xDBFF) {
+                    return 6;
+                }
+                uint32_t low = 0;
+                if (body.substr(at + 6, 2) != "\\u" || !ReadHex(body, at + 8, low) || low < 0xDC00 || low > 0xDFFF) {
+                    return 0;
+                }
+                code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                return 12;
+            }
+            default:
+                return 0;
+        }
+    }
 
-    TYPE TypeVar(std::string line_value);
+    // Whether `bytes` is well-formed UTF-8. Runs of ASCII are skipped sixteen
+    // bytes at a time with SSE2 where it is available.
+    bool ValidUtf8(std::string_view bytes);
 
-    Array* ParseArray(std::string array, Array* final_array);
+    // Decodes the body of a string literal, without its quotes: checks that it
+    // is valid UTF-8, then scans it for the escapes DecodeEscape accepts.
+    // Without escapes `text` borrows `body` and `storage` is
+    // not touched; otherwise `storage` receives the decoded bytes and `text`
+    // views it. With a null `storage` the body is only validated. Fails on an
+    // unescaped quote, an unknown escape or invalid UTF-8.
+    bool DecodeString(std::string_view body, std::string_view& text, std::string* storage);
 
-    bool CheckSection(std::string section);
+    bool CheckSection(const std::string& section);
 }// namespace
\ No newline at end of file
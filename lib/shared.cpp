@@ -0,0 +1,342 @@
+#include "shared.h"
+
+#include <cerrno>
+#include <cstring>
+#include <system_error>
+#include <type_traits>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define OMFL_SHM
+#endif
+
+using namespace omfl;
+
+namespace {
+
+    static_assert(std::atomic<uint64_t>::is_always_lock_free, "the generation must be lock-free across processes");
+    static_assert(std::is_trivially_copyable<FlatSection>::value && std::is_trivially_copyable<FlatVariable>::value,
+                  "flat tables are copied into shared memory as they are");
+
+    const uint32_t kMagic = 0x4c464d4f;
+    const uint32_t kLayout = static_cast<uint32_t>(sizeof(FlatSection) << 16 | sizeof(FlatVariable));
+
+    // Start of every data segment; the tables and the string pool follow at
+    // 8-byte aligned offsets.
+    struct SharedHeader {
+        uint32_t magic;
+        uint32_t layout;
+        uint64_t generation;
+        uint32_t section_count;
+        uint32_t variable_count;
+        uint32_t element_count;
+        uint32_t string_size;
+    };
+
+    struct Offsets {
+        size_t sections;
+        size_t variables;
+        size_t elements;
+        size_t strings;
+        size_t size;
+    };
+
+    size_t Align(size_t offset) {
+        return (offset + 7) & ~size_t(7);
+    }
+
+    Offsets Place(const SharedHeader& header) {
+        Offsets offsets{};
+        offsets.sections = Align(sizeof(SharedHeader));
+        offsets.variables = Align(offsets.sections + header.section_count * sizeof(FlatSection));
+        offsets.elements = Align(offsets.variables + header.variable_count * sizeof(FlatVariable));
+        offsets.strings = Align(offsets.elements + header.element_count * sizeof(FlatVariable));
+        offsets.size = offsets.strings + header.string_size;
+        return offsets;
+    }
+
+    // An empty vector may have a null data(), which memcpy must not get
+    // even for zero bytes.
+    template <typename T>
+    void CopyTable(char* to, const std::vector<T>& table) {
+        if (!table.empty()) {
+            std::memcpy(to, table.data(), table.size() * sizeof(T));
+        }
+    }
+
+    std::string ControlName(const std::string& name) {
+        return '/' + name;
+    }
+
+    std::string SegmentName(const std::string& name, uint64_t generation) {
+        return '/' + name + '-' + std::to_string(generation);
+    }
+
+    [[noreturn]] void Fail(const std::string& name) {
+        throw std::system_error(errno, std::generic_category(), name);
+    }
+
+#ifdef OMFL_SHM
+    // Maps the whole segment. With `create` a missing or empty segment is
+    // created with `size` bytes, otherwise `size` receives the size of the
+    // existing one. Returns nullptr only when the segment does not exist.
+    void* MapSegment(const std::string& name, bool create, size_t& size) {
+        int fd = shm_open(name.c_str(), create ? O_RDWR | O_CREAT : O_RDONLY, 0644);
+        if (fd < 0) {
+            if (errno == ENOENT && !create) {
+                return nullptr;
+            }
+            Fail(name);
+        }
+        struct stat info{};
+        if (fstat(fd, &info) != 0) {
+            close(fd);
+            Fail(name);
+        }
+        if (create && info.st_size == 0) {
+            if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+                close(fd);
+                Fail(name);
+            }
+        } else {
+            size = static_cast<size_t>(info.st_size);
+        }
+        void* data = mmap(nullptr, size, create ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);
+        if (data == MAP_FAILED) {
+            Fail(name);
+        }
+        return data;
+    }
+
+    void UnmapSegment(const void* data, size_t size) {
+        munmap(const_cast<void*>(data), size);
+    }
+
+    void UnlinkSegment(const std::string& name) {
+        shm_unlink(name.c_str());
+    }
+#else
+    void* MapSegment(const std::string& name, bool, size_t&) {
+        throw std::system_error(std::make_error_code(std::errc::function_not_supported), name);
+    }
+
+    void UnmapSegment(const void*, size_t) {}
+
+    void UnlinkSegment(const std::string&) {}
+#endif
+
+}// namespace
+
+std::string SharedElement::GetName() const {
+    if (section_ != nullptr) {
+        return std::string(view_->Text(section_->name));
+    } else if (variable_ != nullptr) {
+        return std::string(view_->Text(variable_->name));
+    }
+    throw std::invalid_argument("Invalid argument");
+}
+
+SharedElement SharedElement::Get(std::string_view path) const {
+    if (section_ == nullptr) {
+        throw std::invalid_argument("Invalid argument");
+    }
+    if (const FlatVariable* variable = view_->FindVariable(path, section_)) {
+        return SharedElement(view_, nullptr, variable);
+    } else if (const FlatSection* section = view_->FindSection(path, section_)) {
+        return SharedElement(view_, section, nullptr);
+    }
+    throw std::invalid_argument("Invalid argument");
+}
+
+SharedElement SharedElement::operator[](int index) const {
+    if (!IsArray() || index < 0 || static_cast<uint32_t>(index) >= variable_->value.count) {
+        return SharedElement();
+    }
+    return SharedElement(view_, nullptr, &view_->elements[variable_->value.first + index]);
+}
+
+int SharedElement::AsInt() const {
+    if (!IsInt()) {
+        throw std::invalid_argument("Invalid argument");
+    }
+    return variable_->int_value;
+}
+
+int SharedElement::AsIntOrDefault(int default_value) const {
+    return IsInt() ? variable_->int_value : default_value;
+}
+
+std::string SharedElement::AsString() const {
+    return std::string(AsStringView());
+}
+
+std::string SharedElement::AsStringOrDefault(std::string default_value) const {
+    return IsString() ? std::string(view_->Text(variable_->value)) : default_value;
+}
+
+std::string_view SharedElement::AsStringView() const {
+    if (!IsString()) {
+        throw std::invalid_argument("Invalid argument");
+    }
+    return view_->Text(variable_->value);
+}
+
+bool SharedElement::AsBool() const {
+    if (!IsBool()) {
+        throw std::invalid_argument("Invalid argument");
+    }
+    return variable_->bool_value;
+}
+
+float SharedElement::AsFloat() const {
+    if (!IsFloat()) {
+        throw std::invalid_argument("Invalid argument");
+    }
+    return variable_->float_value;
+}
+
+float SharedElement::AsFloatOrDefault(float default_value) const {
+    return IsFloat() ? variable_->float_value : default_value;
+}
+
+SharedPublisher::SharedPublisher(std::string name) : name_(std::move(name)) {
+    if (name_.empty() || name_.find('/') != std::string::npos) {
+        throw std::invalid_argument("Invalid argument");
+    }
+    size_t size = sizeof(std::atomic<uint64_t>);
+    generation_ = static_cast<std::atomic<uint64_t>*>(MapSegment(ControlName(name_), true, size));
+}
+
+SharedPublisher::~SharedPublisher() {
+    UnmapSegment(generation_, sizeof(std::atomic<uint64_t>));
+}
+
+uint64_t SharedPublisher::Publish(const Parser& parser) {
+    FlatDocument document = Flatten(parser);
+    uint64_t previous = Generation();
+    uint64_t generation = previous + 1;
+
+    SharedHeader header{kMagic, kLayout, generation,
+                        static_cast<uint32_t>(document.Sections().size()),
+                        static_cast<uint32_t>(document.Variables().size()),
+                        static_cast<uint32_t>(document.Elements().size()),
+                        static_cast<uint32_t>(document.Strings().size())};
+    Offsets offsets = Place(header);
+    std::string segment = SegmentName(name_, generation);
+    // A segment left over by a publisher that stopped before advancing the
+    // generation is replaced.
+    UnlinkSegment(segment);
+    size_t size = offsets.size;
+    char* data = static_cast<char*>(MapSegment(segment, true, size));
+    std::memcpy(data, &header, sizeof(header));
+    CopyTable(data + offsets.sections, document.Sections());
+    CopyTable(data + offsets.variables, document.Variables());
+    CopyTable(data + offsets.elements, document.Elements());
+    if (header.string_size > 0) {
+        std::memcpy(data + offsets.strings, document.Strings().data(), header.string_size);
+    }
+    UnmapSegment(data, size);
+
+    generation_->store(generation, std::memory_order_release);
+    if (previous != 0) {
+        UnlinkSegment(SegmentName(name_, previous));
+    }
+    return generation;
+}
+
+void SharedPublisher::Unlink() {
+    uint64_t generation = Generation();
+    if (generation != 0) {
+        UnlinkSegment(SegmentName(name_, generation));
+    }
+    UnlinkSegment(ControlName(name_));
+}
+
+SharedReader::SharedReader(std::string name) : name_(std::move(name)) {
+    if (name_.empty() || name_.find('/') != std::string::npos) {
+        throw std::invalid_argument("Invalid argument");
+    }
+    size_t size = 0;
+    const void* control = MapSegment(ControlName(name_), false, size);
+    if (control == nullptr) {
+        errno = ENOENT;
+        Fail(ControlName(name_));
+    }
+    if (size < sizeof(std::atomic<uint64_t>)) {
+        UnmapSegment(control, size);
+        throw std::invalid_argument("Invalid argument");
+    }
+    generation_ = static_cast<const std::atomic<uint64_t>*>(control);
+    Refresh();
+}
+
+SharedReader::~SharedReader() {
+    Detach();
+    UnmapSegment(generation_, sizeof(std::atomic<uint64_t>));
+}
+
+void SharedReader::Detach() {
+    if (data_ != nullptr) {
+        UnmapSegment(data_, size_);
+    }
+    data_ = nullptr;
+    size_ = 0;
+    attached_ = 0;
+    view_ = FlatView();
+}
+
+bool SharedReader::Refresh() {
+    uint64_t generation = generation_->load(std::memory_order_acquire);
+    while (generation != attached_ && generation != 0) {
+        size_t size = 0;
+        const char* data = static_cast<const char*>(MapSegment(SegmentName(name_, generation), false, size));
+        if (data == nullptr) {
+            // Superseded and unlinked between the load and the open.
+            uint64_t current = generation_->load(std::memory_order_acquire);
+            if (current == generation) {
+                errno = ENOENT;
+                Fail(SegmentName(name_, generation));
+            }
+            generation = current;
+            continue;
+        }
+        SharedHeader header{};
+        if (size >= sizeof(header)) {
+            std::memcpy(&header, data, sizeof(header));
+        }
+        if (size < sizeof(header) || header.magic != kMagic || header.layout != kLayout ||
+            header.generation != generation || Place(header).size > size || header.section_count == 0) {
+            UnmapSegment(data, size);
+            throw std::invalid_argument("Invalid argument");
+        }
+        Detach();
+        Offsets offsets = Place(header);
+        data_ = data;
+        size_ = size;
+        attached_ = generation;
+        view_.sections = reinterpret_cast<const FlatSection*>(data + offsets.sections);
+        view_.variables = reinterpret_cast<const FlatVariable*>(data + offsets.variables);
+        view_.elements = reinterpret_cast<const FlatVariable*>(data + offsets.elements);
+        view_.strings = std::string_view(data + offsets.strings, header.string_size);
+        return true;
+    }
+    return false;
+}
+
+SharedElement SharedReader::Root() const {
+    if (data_ == nullptr) {
+        return SharedElement();
+    }
+    return SharedElement(&view_, view_.sections, nullptr);
+}
+
+SharedElement SharedReader::Get(std::string_view path) const {
+    if (data_ == nullptr) {
+        throw std::invalid_argument("Invalid argument");
+    }
+    return Root().Get(path);
+}
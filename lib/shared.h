@@ -0,0 +1,145 @@
+#pragma once
+
+#include "flat.h"
+
+#include <atomic>
+
+namespace omfl {
+
+    // A section or variable of a published document, read in place from the
+    // mapped segment with the same accessors as Element. A handle stays valid
+    // until the SharedReader it came from moves to another generation.
+    class SharedElement {
+        const FlatView* view_ = nullptr;
+        const FlatSection* section_ = nullptr;
+        const FlatVariable* variable_ = nullptr;
+
+    public:
+        SharedElement() = default;
+
+        SharedElement(const FlatView* view, const FlatSection* section, const FlatVariable* variable)
+            : view_(view), section_(section), variable_(variable) {}
+
+        [[nodiscard]] std::string GetName() const;
+
+        // Section or variable at a dotted path below this section.
+        [[nodiscard]] SharedElement Get(std::string_view path) const;
+
+        // Out of range, or on anything but an array, the result is an empty
+        // element for which only the *OrDefault accessors succeed.
+        SharedElement operator[](int index) const;
+
+        [[nodiscard]] bool IsSection() const {
+            return section_ != nullptr;
+        }
+
+        [[nodiscard]] bool IsInt() const {
+            return variable_ != nullptr && variable_->type == INT;
+        }
+
+        [[nodiscard]] bool IsString() const {
+            return variable_ != nullptr && variable_->type == STRING;
+        }
+
+        [[nodiscard]] bool IsFloat() const {
+            return variable_ != nullptr && variable_->type == FLOAT;
+        }
+
+        [[nodiscard]] bool IsBool() const {
+            return variable_ != nullptr && variable_->type == BOOL;
+        }
+
+        [[nodiscard]] bool IsArray() const {
+            return variable_ != nullptr && variable_->type == ARRAY;
+        }
+
+        [[nodiscard]] int AsInt() const;
+
+        [[nodiscard]] int AsIntOrDefault(int default_value) const;
+
+        [[nodiscard]] std::string AsString() const;
+
+        [[nodiscard]] std::string AsStringOrDefault(std::string default_value) const;
+
+        // The string bytes in the segment itself, without copying them.
+        [[nodiscard]] std::string_view AsStringView() const;
+
+        [[nodiscard]] bool AsBool() const;
+
+        [[nodiscard]] float AsFloat() const;
+
+        [[nodiscard]] float AsFloatOrDefault(float default_value) const;
+    };
+
+    // Publishes documents under a name for SharedReader in other processes.
+    // Every version is written as a flattened image into a new segment
+    // "<name>-<generation>"; only when it is complete is the generation in
+    // the control segment "<name>" advanced, and the previous segment
+    // unlinked. Processes still mapping that segment keep reading it. One
+    // publisher per name.
+    class SharedPublisher {
+        std::string name_;
+        std::atomic<uint64_t>* generation_ = nullptr;
+
+    public:
+        explicit SharedPublisher(std::string name);
+
+        SharedPublisher(const SharedPublisher&) = delete;
+
+        SharedPublisher& operator=(const SharedPublisher&) = delete;
+
+        ~SharedPublisher();
+
+        // Returns the generation the document was published as.
+        uint64_t Publish(const Parser& parser);
+
+        [[nodiscard]] uint64_t Generation() const {
+            return generation_->load(std::memory_order_acquire);
+        }
+
+        // Removes the control and the current data segment names; readers
+        // already attached are unaffected.
+        void Unlink();
+    };
+
+    // Read-only attachment to the latest document published under a name.
+    // Checking for a new generation is a single atomic load, no lock is
+    // shared with the publisher or other readers.
+    class SharedReader {
+        std::string name_;
+        const std::atomic<uint64_t>* generation_ = nullptr;
+        const void* data_ = nullptr;
+        size_t size_ = 0;
+        uint64_t attached_ = 0;
+        FlatView view_;
+
+        void Detach();
+
+    public:
+        // Throws std::system_error when nothing was ever published as `name`.
+        explicit SharedReader(std::string name);
+
+        SharedReader(const SharedReader&) = delete;
+
+        SharedReader& operator=(const SharedReader&) = delete;
+
+        ~SharedReader();
+
+        // Attaches to the current generation if it changed, invalidating
+        // every SharedElement obtained before. Returns whether it did.
+        bool Refresh();
+
+        [[nodiscard]] uint64_t Generation() const {
+            return attached_;
+        }
+
+        [[nodiscard]] const FlatView& View() const {
+            return view_;
+        }
+
+        [[nodiscard]] SharedElement Root() const;
+
+        // Throws std::invalid_argument when there is no such path.
+        [[nodiscard]] SharedElement Get(std::string_view path) const;
+    };
+}// namespace
@@ -0,0 +1,86 @@
+#include <lib/async.h>
+
+#include <gtest/gtest.h>
+
+#include <fstream>
+
+using namespace omfl;
+
+namespace {
+
+    class AsyncTestSuite : public testing::Test {
+    protected:
+        std::filesystem::path directory_;
+
+        void SetUp() override {
+            directory_ = std::filesystem::temp_directory_path() /
+                         ("omfl_async_" + std::to_string(reinterpret_cast<uintptr_t>(this)));
+            std::filesystem::create_directories(directory_);
+        }
+
+        void TearDown() override {
+            std::filesystem::remove_all(directory_);
+        }
+
+        std::filesystem::path Write(const std::string& name, const std::string& data) {
+            std::filesystem::path path = directory_ / name;
+            std::ofstream(path, std::ios::binary) << data;
+            return path;
+        }
+    };
+
+}// namespace
+
+TEST_F(AsyncTestSuite, ResultsMatchTheirFilesTest) {
+    std::vector<std::filesystem::path> paths;
+    for (int i = 0; i < 40; i++) {
+        paths.push_back(Write(std::to_string(i) + ".omfl", "index = " + std::to_string(i) + "\n"));
+    }
+    AsyncLoader loader(3, 2);
+
+    std::vector<std::future<Parser>> results;
+    for (const std::filesystem::path& path : paths) {
+        results.push_back(loader.AsyncParse(path));
+    }
+
+    for (int i = 0; i < 40; i++) {
+        Parser parser = results[i].get();
+        ASSERT_TRUE(parser.valid());
+        ASSERT_EQ(parser.Get("index").AsInt(), i);
+    }
+}
+
+TEST_F(AsyncTestSuite, InvalidDocumentTest) {
+    std::filesystem::path path = Write("bad.omfl", "key = [1, 2\n");
+
+    Parser parser = AsyncParse(path).get();
+
+    ASSERT_FALSE(parser.valid());
+}
+
+TEST_F(AsyncTestSuite, DestructorFinishesPendingTest) {
+    std::vector<std::future<Parser>> results;
+    {
+        AsyncLoader loader(1, 1);
+        for (int i = 0; i < 10; i++) {
+            results.push_back(loader.AsyncParse(Write(std::to_string(i) + ".omfl", "a = true\n")));
+        }
+    }
+
+    for (std::future<Parser>& result : results) {
+        ASSERT_TRUE(result.get().Get("a").AsBool());
+    }
+}
+
+TEST_F(AsyncTestSuite, UnreadableFileTest) {
+    AsyncLoader loader(1, 1);
+    std::future<Parser> missing = loader.AsyncParse(directory_ / "missing.omfl");
+    std::future<Parser> folder = loader.AsyncParse(directory_);
+
+    for (std::future<Parser>* result : {&missing, &folder}) {
+        Parser parser = result->get();
+        ASSERT_FALSE(parser.valid());
+        ASSERT_EQ(parser.GetDiagnostics().size(), 1u);
+        ASSERT_EQ(parser.GetDiagnostics()[0].kind, UNREADABLE_INPUT);
+    }
+}
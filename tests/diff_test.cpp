@@ -0,0 +1,55 @@
+#include <lib/diff.h>
+
+#include <gtest/gtest.h>
+
+using namespace omfl;
+
+namespace {
+
+    std::vector<std::pair<CHANGE, std::string>> Changes(const std::string& before, const std::string& after) {
+        std::vector<std::pair<CHANGE, std::string>> result;
+        for (const Change& change : Diff(parse(before), parse(after))) {
+            result.emplace_back(change.kind, change.path);
+        }
+        return result;
+    }
+
+}// namespace
+
+TEST(DiffTestSuite, HashIgnoresOrderTest) {
+    Parser first = parse(std::string("a = 1\nb = \"x\"\n[s]\nc = [1, 2]\n[t]\nd = true\n"));
+    Parser second = parse(std::string("a = 1\n[t]\nd = true\n[s]\nc = [1, 2]\n"));
+    Parser reordered = parse(std::string("b = \"x\"\na = 1\n[t]\nd = true\n[s]\nc = [1, 2]\n"));
+
+    ASSERT_EQ(Hash(first), Hash(reordered));
+    ASSERT_NE(Hash(first), Hash(second));
+}
+
+TEST(DiffTestSuite, HashSeesValuesTest) {
+    std::string base = "a = 1\n[s]\nc = [1, 2]\n";
+
+    ASSERT_EQ(Hash(parse(base)), Hash(parse(base)));
+    ASSERT_NE(Hash(parse(base)), Hash(parse(std::string("a = 2\n[s]\nc = [1, 2]\n"))));
+    ASSERT_NE(Hash(parse(base)), Hash(parse(std::string("a = 1\n[s]\nc = [2, 1]\n"))));
+    ASSERT_NE(Hash(parse(base)), Hash(parse(std::string("a = \"1\"\n[s]\nc = [1, 2]\n"))));
+    ASSERT_NE(Hash(parse(base)), Hash(parse(std::string("a = 1\n[t]\nc = [1, 2]\n"))));
+}
+
+TEST(DiffTestSuite, NoChangesTest) {
+    ASSERT_TRUE(Changes("a = 1\n[s]\nb = 2\n[t]\n", "a = 1\n[t]\n[s]\nb = 2\n").empty());
+}
+
+TEST(DiffTestSuite, ChangesTest) {
+    std::vector<std::pair<CHANGE, std::string>> expected = {
+        {REMOVED, "a"},
+        {CHANGED, "b"},
+        {ADDED, "c"},
+        {CHANGED, "s.x"},
+        {REMOVED, "gone"},
+        {ADDED, "new"},
+    };
+
+    ASSERT_EQ(Changes("a = 1\nb = 2\n[s]\nx = [1]\ny = 1\n[gone]\nz = 1\n",
+                      "b = 3\nc = 4\n[s]\nx = [1, 2]\ny = 1\n[new]\nz = 1\n"),
+              expected);
+}
@@ -0,0 +1,118 @@
+#include <lib/editor.h>
+
+#include <gtest/gtest.h>
+
+using namespace omfl;
+
+namespace {
+
+    Parser Base() {
+        return parse(std::string("name = \"base\"\n"
+                                 "[servers.first]\nip = \"10.0.0.1\"\nport = 80\n"
+                                 "[servers.second]\nip = \"10.0.0.2\"\n"
+                                 "[clients]\nlimit = 5\n"));
+    }
+
+}// namespace
+
+TEST(EditorTestSuite, SetTest) {
+    Parser base = Base();
+
+    Parser version = Editor(base).SetInt("servers.first.port", 8080).SetString("name", "next").Commit();
+
+    ASSERT_TRUE(version.valid());
+    ASSERT_EQ(version.Global().FindChild("servers")->FindChild("first")->FindVar("port")->AsInt(), 8080);
+    ASSERT_EQ(version.Global().FindVar("name")->AsString(), "next");
+}
+
+TEST(EditorTestSuite, BaseIsNotModifiedTest) {
+    Parser base = Base();
+
+    Parser version = Editor(base).SetInt("servers.first.port", 8080).Remove("clients").Commit();
+
+    Section* first = base.Global().FindChild("servers")->FindChild("first");
+    ASSERT_EQ(first->FindVar("port")->AsInt(), 80);
+    ASSERT_NE(base.Global().FindChild("clients"), nullptr);
+    ASSERT_EQ(version.Global().FindChild("clients"), nullptr);
+}
+
+TEST(EditorTestSuite, StructuralSharingTest) {
+    Parser base = Base();
+
+    Parser version = Editor(base).SetInt("servers.first.port", 8080).Commit();
+
+    Section* base_servers = base.Global().FindChild("servers");
+    Section* servers = version.Global().FindChild("servers");
+    // Sections on the edited path are copied, everything else is shared.
+    ASSERT_NE(servers, base_servers);
+    ASSERT_NE(servers->FindChild("first"), base_servers->FindChild("first"));
+    ASSERT_EQ(servers->FindChild("second"), base_servers->FindChild("second"));
+    ASSERT_EQ(version.Global().FindChild("clients"), base.Global().FindChild("clients"));
+    ASSERT_EQ(servers->FindChild("first")->FindVar("ip"), base_servers->FindChild("first")->FindVar("ip"));
+}
+
+TEST(EditorTestSuite, RemoveTest) {
+    Parser base = Base();
+
+    Parser version = Editor(base).Remove("servers.first.port").Remove("servers.second").Remove("missing.key").Commit();
+
+    Section* servers = version.Global().FindChild("servers");
+    ASSERT_EQ(servers->FindChild("first")->FindVar("port"), nullptr);
+    ASSERT_NE(servers->FindChild("first")->FindVar("ip"), nullptr);
+    ASSERT_EQ(servers->FindChild("second"), nullptr);
+    ASSERT_EQ(version.Global().FindChild("missing"), nullptr);
+}
+
+TEST(EditorTestSuite, InsertTest) {
+    Parser base = Base();
+
+    Parser version = Editor(base).InsertSection("servers.third").SetBool("new.section.flag", true).Commit();
+
+    ASSERT_NE(version.Global().FindChild("servers")->FindChild("third"), nullptr);
+    ASSERT_TRUE(version.Global().FindChild("new")->FindChild("section")->FindVar("flag")->AsBool());
+    ASSERT_EQ(base.Global().FindChild("new"), nullptr);
+}
+
+TEST(EditorTestSuite, VersionsAreIndependentTest) {
+    Parser base = Base();
+    Editor editor(base);
+    editor.SetInt("clients.limit", 6);
+
+    Parser first = editor.Commit();
+    Parser second = Editor(first).SetInt("clients.limit", 7).Commit();
+
+    ASSERT_EQ(base.Global().FindChild("clients")->FindVar("limit")->AsInt(), 5);
+    ASSERT_EQ(first.Global().FindChild("clients")->FindVar("limit")->AsInt(), 6);
+    ASSERT_EQ(second.Global().FindChild("clients")->FindVar("limit")->AsInt(), 7);
+    ASSERT_EQ(editor.Size(), 1u);
+}
+
+TEST(EditorTestSuite, InvalidPathTest) {
+    Parser base = Base();
+    Editor editor(base);
+
+    ASSERT_THROW(editor.SetInt("bad name", 1), std::invalid_argument);
+    ASSERT_THROW(editor.SetInt("", 3), std::invalid_argument);
+    ASSERT_THROW(editor.SetString("servers..ip", "x"), std::invalid_argument);
+    ASSERT_THROW(editor.SetBool("servers.first.", true), std::invalid_argument);
+    ASSERT_THROW(editor.SetFloat("servers.first.bad=key", 1.5f), std::invalid_argument);
+    ASSERT_THROW(editor.Remove(".clients"), std::invalid_argument);
+    ASSERT_THROW(editor.InsertSection("servers.[third]"), std::invalid_argument);
+    ASSERT_EQ(editor.Size(), 0u);
+}
+
+TEST(EditorTestSuite, CommittedValuesOutliveTheEditorTest) {
+    Parser base = Base();
+    Parser version;
+    {
+        Editor editor(base);
+        editor.SetString("name", "kept").SetInt("dropped", 1);
+        version = editor.Commit();
+        editor.Clear();
+        editor.SetInt("pending", 2);
+    }
+
+    ASSERT_EQ(version.Global().FindVar("name")->AsString(), "kept");
+    ASSERT_EQ(version.Global().FindVar("dropped")->AsInt(), 1);
+    ASSERT_EQ(version.Global().FindVar("pending"), nullptr);
+}
@@ -0,0 +1,78 @@
+#include <lib/embed.h>
+
+#include <gtest/gtest.h>
+
+using namespace omfl;
+
+namespace {
+
+    OMFL_EMBED(kEmbedded, R"(
+    title = "embedded"
+    count = 42
+    ratio = 0.5
+    enabled = true
+    [servers.first]
+    ports = [80, 443]
+    )");
+
+    static_assert(kEmbedded.Find("count") != nullptr && kEmbedded.Find("count")->int_value == 42);
+    static_assert(kEmbedded.Find("servers.first.ports") != nullptr);
+    static_assert(kEmbedded.Find("missing") == nullptr);
+
+}// namespace
+
+TEST(EmbedTestSuite, ValidTest) {
+    constexpr auto config = Embed<4>("a = 1\n[s]\nb = \"x\"\n");
+
+    ASSERT_TRUE(config.valid);
+    ASSERT_EQ(config.Find("a")->int_value, 1);
+    ASSERT_EQ(config.Find("s.b")->text, "x");
+}
+
+TEST(EmbedTestSuite, InvalidTest) {
+    ASSERT_FALSE(Embed<4>("a = \n").valid);
+    ASSERT_FALSE(Embed<4>("a = 1\na = 2\n").valid);
+    ASSERT_FALSE(Embed<4>("a = 99999999999\n").valid);
+    ASSERT_FALSE(Embed<4>("[s..t]\n").valid);
+    ASSERT_FALSE(Embed<4>("a = [1, \"x\"\n").valid);
+
+    constexpr auto broken = Embed<4>("a = 1\nb c\n");
+    ASSERT_FALSE(broken.valid);
+    ASSERT_EQ(broken.error_line, 2u);
+}
+
+TEST(EmbedTestSuite, MaterializeTest) {
+    Parser parser = Materialize(kEmbedded);
+
+    ASSERT_TRUE(parser.valid());
+    ASSERT_EQ(parser.Get("title").AsString(), "embedded");
+    ASSERT_EQ(parser.Get("count").AsInt(), 42);
+    ASSERT_FLOAT_EQ(parser.Get("ratio").AsFloat(), 0.5f);
+    ASSERT_TRUE(parser.Get("enabled").AsBool());
+    ASSERT_EQ(parser.Get("servers").Get("first").Get("ports")[1].AsInt(), 443);
+}
+
+TEST(EmbedTestSuite, FloatRangeTest) {
+    const std::string_view inputs[] = {
+        "a = 0.00000000000000000000000000000000000001\n",
+        "a = 0.0000000000000000000000000000000000000117549434\n",
+        "a = -0.0000000000000000000000000000000000000000000\n",
+        "a = 340282356779733661637539395458142568447.9\n",
+        "a = 340282356779733661637539395458142568448.0\n",
+        "a = [0.00000000000000000000000000000000000001]\n",
+        "a = [0.0000000000000000000000000000000000000000000007]\n",
+        "a = 33433433.0000000000000000000000000000000000062\n",
+        "a = -27274562832021395249397276.839134075596447069595\n",
+    };
+    for (std::string_view input : inputs) {
+        Parser expected = parse(std::string(input));
+        auto config = Embed<4>(input);
+
+        ASSERT_EQ(config.valid, expected.valid()) << input;
+        if (expected.valid() && expected.Get("a").IsFloat()) {
+            ASSERT_EQ(Materialize(config).Get("a").AsFloat(), expected.Get("a").AsFloat()) << input;
+        }
+    }
+    ASSERT_FALSE(Embed<4>("a = 0.00000000000000000000000000000000000001\n").valid);
+    ASSERT_TRUE(Embed<4>("a = 340282356779733661637539395458142568447.9\n").valid);
+}
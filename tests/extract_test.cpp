@@ -0,0 +1,62 @@
+#include <lib/extract.h>
+
+#include <gtest/gtest.h>
+
+using namespace omfl;
+
+TEST(ExtractTestSuite, ColumnsTest) {
+    std::vector<Parser> parsed = {
+            parse(std::string("[server]\nport = 80\nhost = \"a\"\nratio = 0.5\nup = true\n")),
+            parse(std::string("[server]\nport = \"eighty\"\nratio = 1.5\nup = false\n")),
+            parse(std::string("other = 1\n")),
+    };
+    std::vector<const Parser*> documents;
+    for (const Parser& document : parsed) {
+        documents.push_back(&document);
+    }
+
+    Table table = Extract({{"server.port", INT}, {"server.host", STRING}, {"server.ratio", FLOAT},
+                           {"server.up", BOOL}}, documents, 2);
+
+    ASSERT_EQ(table.rows, 3u);
+    ASSERT_EQ(table.columns.size(), 4u);
+    const Column& port = table.columns[0];
+    ASSERT_EQ(port.path, "server.port");
+    ASSERT_TRUE(port.IsValid(0));
+    ASSERT_EQ(port.ints[0], 80);
+    // A value of another type counts as missing.
+    ASSERT_FALSE(port.IsValid(1));
+    ASSERT_FALSE(port.IsValid(2));
+    const Column& host = table.columns[1];
+    ASSERT_TRUE(host.IsValid(0));
+    ASSERT_EQ(host.StringAt(0), "a");
+    ASSERT_FALSE(host.IsValid(1));
+    ASSERT_EQ(host.StringAt(1), "");
+    const Column& ratio = table.columns[2];
+    ASSERT_DOUBLE_EQ(ratio.floats[0], 0.5);
+    ASSERT_DOUBLE_EQ(ratio.floats[1], 1.5);
+    ASSERT_FALSE(ratio.IsValid(2));
+    const Column& up = table.columns[3];
+    ASSERT_EQ(up.ints[0], 1);
+    ASSERT_EQ(up.ints[1], 0);
+    ASSERT_TRUE(up.IsValid(1));
+}
+
+TEST(ExtractTestSuite, ManyRowsTest) {
+    std::vector<Parser> parsed;
+    for (int i = 0; i < 200; i++) {
+        parsed.push_back(parse("value = " + std::to_string(i) + "\n"));
+    }
+    std::vector<const Parser*> documents;
+    for (const Parser& document : parsed) {
+        documents.push_back(&document);
+    }
+
+    Table table = Extract({{"value", INT}}, documents, 3);
+
+    ASSERT_EQ(table.rows, 200u);
+    for (size_t row = 0; row < 200; row++) {
+        ASSERT_TRUE(table.columns[0].IsValid(row));
+        ASSERT_EQ(table.columns[0].ints[row], static_cast<int64_t>(row));
+    }
+}
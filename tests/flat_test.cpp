@@ -0,0 +1,54 @@
+#include <lib/flat.h>
+
+#include <gtest/gtest.h>
+
+using namespace omfl;
+
+TEST(FlatTestSuite, LayoutTest) {
+    Parser parser = parse(std::string("title = \"x\"\nlist = [1, [2, 3]]\n[a]\n[a.b]\nkey = true\n[c]\nf = 1.5\n"));
+
+    FlatDocument document = Flatten(parser);
+
+    // Breadth-first: root, a, c, b.
+    ASSERT_EQ(document.Sections().size(), 4u);
+    ASSERT_EQ(document.Text(document.Sections()[1].name), "a");
+    ASSERT_EQ(document.Text(document.Sections()[2].name), "c");
+    ASSERT_EQ(document.Text(document.Sections()[3].name), "b");
+    ASSERT_EQ(document.Sections()[3].parent, 1u);
+    ASSERT_EQ(document.Root().children.count, 2u);
+    ASSERT_EQ(document.Root().variables.count, 2u);
+    ASSERT_EQ(document.Elements().size(), 4u);
+}
+
+TEST(FlatTestSuite, LookupTest) {
+    Parser parser = parse(std::string("title = \"x\"\nlist = [1, [2, 3]]\n[a.b]\nkey = true\n"));
+
+    FlatDocument document = Flatten(parser);
+
+    const FlatVariable* title = document.FindVariable("title");
+    ASSERT_NE(title, nullptr);
+    ASSERT_EQ(title->type, STRING);
+    ASSERT_EQ(document.Text(title->value), "x");
+    const FlatVariable* key = document.FindVariable("a.b.key");
+    ASSERT_NE(key, nullptr);
+    ASSERT_TRUE(key->bool_value);
+    const FlatVariable* list = document.FindVariable("list");
+    ASSERT_EQ(list->type, ARRAY);
+    const FlatVariable& nested = document.Elements()[list->value.first + 1];
+    ASSERT_EQ(nested.type, ARRAY);
+    ASSERT_EQ(document.Elements()[nested.value.first + 1].int_value, 3);
+    ASSERT_NE(document.FindSection("a.b"), nullptr);
+    ASSERT_EQ(document.FindSection("a.c"), nullptr);
+    ASSERT_EQ(document.FindVariable("a.key"), nullptr);
+}
+
+TEST(FlatTestSuite, ConstDocumentTest) {
+    const Parser parser = parse(std::string("[s]\nx = [2, 3]\n"));
+
+    FlatDocument document = Flatten(parser);
+
+    const FlatVariable* x = document.FindVariable("s.x");
+    ASSERT_NE(x, nullptr);
+    ASSERT_EQ(x->type, ARRAY);
+    ASSERT_EQ(x->value.count, 2u);
+}
@@ -0,0 +1,52 @@
+#include <lib/layered.h>
+
+#include <gtest/gtest.h>
+
+using namespace omfl;
+
+namespace {
+
+    Layered Stack() {
+        return Layered({parse(std::string("port = 80\nhost = \"base\"\n[db]\nuser = \"root\"\n")),
+                        parse(std::string("port = 8080\n[db]\npassword = \"secret\"\n")),
+                        parse(std::string("[db]\nuser = \"app\"\n"))});
+    }
+
+}// namespace
+
+TEST(LayeredTestSuite, OverrideTest) {
+    Layered layered = Stack();
+
+    ASSERT_EQ(layered.Size(), 3u);
+    ASSERT_EQ(layered.Get("port").AsInt(), 8080);
+    ASSERT_EQ(layered.LayerOf("port"), 1u);
+    ASSERT_EQ(layered.Get("host").AsString(), "base");
+    ASSERT_EQ(layered.LayerOf("host"), 0u);
+    ASSERT_EQ(layered.Get("db.user").AsString(), "app");
+    ASSERT_EQ(layered.Get("db.password").AsString(), "secret");
+    ASSERT_EQ(layered.Find("db.missing"), nullptr);
+    ASSERT_EQ(layered.LayerOf("db.missing"), layered.Size());
+}
+
+TEST(LayeredTestSuite, ReplaceTest) {
+    Layered layered = Stack();
+
+    layered.Replace(1, parse(std::string("host = \"middle\"\n")));
+
+    // port falls back to the base, host now comes from the replaced layer.
+    ASSERT_EQ(layered.Get("port").AsInt(), 80);
+    ASSERT_EQ(layered.LayerOf("port"), 0u);
+    ASSERT_EQ(layered.Get("host").AsString(), "middle");
+    ASSERT_EQ(layered.LayerOf("host"), 1u);
+    ASSERT_EQ(layered.Find("db.password"), nullptr);
+    ASSERT_EQ(layered.Get("db.user").AsString(), "app");
+}
+
+TEST(LayeredTestSuite, ReplaceTopLayerTest) {
+    Layered layered = Stack();
+
+    layered.Replace(2, parse(std::string("port = 1\n")));
+
+    ASSERT_EQ(layered.Get("port").AsInt(), 1);
+    ASSERT_EQ(layered.Get("db.user").AsString(), "root");
+}
@@ -0,0 +1,77 @@
+#include <lib/diff.h>
+#include <lib/memory.h>
+
+#include <gtest/gtest.h>
+
+using namespace omfl;
+
+namespace {
+
+    const std::string kDocument = "a = 1\n"
+                                  "b = \"a string value too long for the inline buffer\"\n"
+                                  "[s]\na = 1\nc = [1, 1, [2]]\nd = 2.5\n"
+                                  "[s.t]\nb = \"a string value too long for the inline buffer\"\n";
+
+}// namespace
+
+TEST(MemoryTestSuite, CountsTest) {
+    Parser parser = parse(kDocument);
+    MemoryReport report = MemoryUsage(parser);
+
+    ASSERT_EQ(report.section_count, 3u);
+    ASSERT_EQ(report.array_count, 2u);
+    ASSERT_EQ(report.variable_count, 8u);
+    ASSERT_GT(report.strings, 0u);
+    ASSERT_EQ(report.Total(), report.document + report.sections + report.variables + report.arrays +
+                                  report.strings + report.slack);
+}
+
+TEST(MemoryTestSuite, CompactSharesEqualNodesTest) {
+    Parser parser = parse(kDocument);
+    MemoryReport before = MemoryUsage(parser);
+
+    Compact(parser);
+    MemoryReport after = MemoryUsage(parser);
+
+    // s.a is shared with a, s.t.b with b and the two 1s in c with each other.
+    ASSERT_EQ(after.variable_count, 5u);
+    ASSERT_EQ(after.array_count, 2u);
+    ASSERT_EQ(after.section_count, 3u);
+    ASSERT_LT(after.Total(), before.Total());
+    ASSERT_LE(after.slack, before.slack);
+}
+
+TEST(MemoryTestSuite, CompactKeepsValuesTest) {
+    Parser parser = parse(kDocument);
+    Hash128 hash = Hash(parser);
+
+    Compact(parser);
+
+    ASSERT_EQ(Hash(parser), hash);
+    ASSERT_TRUE(parser.valid());
+    ASSERT_EQ(parser.Get("a").AsInt(), 1);
+    ASSERT_EQ(parser.Get("s").Get("a").AsInt(), 1);
+    ASSERT_EQ(parser.Get("s").Get("c")[1].AsInt(), 1);
+    ASSERT_EQ(parser.Get("s").Get("c")[2][0].AsInt(), 2);
+    ASSERT_FLOAT_EQ(parser.Get("s").Get("d").AsFloat(), 2.5f);
+    ASSERT_EQ(parser.Get("s").Get("t").Get("b").AsString(), parser.Get("b").AsString());
+}
+
+TEST(MemoryTestSuite, DeepArrayTest) {
+    const size_t depth = 200000;
+    std::string data = "a = " + std::string(depth, '[') + "1" + std::string(depth, ']') + "\n";
+
+    Parser parser = parse(data);
+    ASSERT_TRUE(parser.valid());
+    Hash128 hash = Hash(parser);
+    ASSERT_EQ(hash, Hash(parse(data)));
+    ASSERT_NE(hash, Hash(parse("a = " + std::string(depth, '[') + "2" + std::string(depth, ']') + "\n")));
+
+    MemoryReport report = MemoryUsage(parser);
+    ASSERT_EQ(report.array_count, depth);
+    ASSERT_EQ(report.variable_count, 1u);
+
+    Compact(parser);
+    ASSERT_EQ(Hash(parser), hash);
+    ASSERT_EQ(MemoryUsage(parser).array_count, depth);
+}
@@ -0,0 +1,371 @@
+#include <lib/parser.h>
+
+#include <gtest/gtest.h>
+
+using namespace omfl;
+
+TEST(ParserTestSuite, EmptyTest) {
+    std::string data = R"(
+        key = "value"
+        key2 = "value2"
+    )";
+
+    Parser root = parse(data);
+
+    ASSERT_TRUE(root.valid());
+}
+
+TEST(ParserTestSuite, SectionsTest) {
+    std::string data = R"(
+        [common]
+        name = "Common config"
+        version = 1
+
+        [servers.first]
+        enabled = true
+        ip = "127.0.0.1"
+    )";
+
+    Parser root = parse(data);
+
+    ASSERT_TRUE(root.valid());
+    ASSERT_EQ(root.Get("common.version").AsInt(), 1);
+    ASSERT_EQ(root.Get("common.name").AsString(), "Common config");
+    ASSERT_TRUE(root.Get("servers.first.enabled").AsBool());
+}
+
+TEST(ParserTestSuite, DuplicateKeyTest) {
+    for (const char* data : {"key = 1\nkey = 2", "key = \"a\"\nkey = \"b\"", "key = true\nkey = false",
+                             "key = 1.5\nkey = 2.5", "key = [1]\nkey = [2]", "key = 1\nkey = \"other type\"",
+                             "[a]\nkey = 1\n[b]\n[a]\nkey = 2"}) {
+        ASSERT_FALSE(parse(std::string(data)).valid()) << data;
+    }
+}
+
+TEST(ParserTestSuite, SectionRejectsDuplicateTest) {
+    Section section("s");
+    std::string name = "key";
+    section.AddNewIntVar(name, 1);
+
+    name = "key";
+    ASSERT_THROW(section.AddNewIntVar(name, 2), std::invalid_argument);
+    name = "key";
+    ASSERT_THROW(section.AddNewStringVar(name, "b"), std::invalid_argument);
+    name = "key";
+    ASSERT_THROW(section.AddNewBoolVar(name, true), std::invalid_argument);
+    name = "key";
+    ASSERT_THROW(section.AddNewFloatVar(name, 2.5f), std::invalid_argument);
+    ASSERT_THROW(section.AddNewArray("key", *ParseArray("[2]")), std::invalid_argument);
+
+    // The list and the index still agree on the first value.
+    ASSERT_EQ(section.GetArr().size(), 1u);
+    ASSERT_EQ(section.GetArr()[0], section.FindVar("key"));
+    ASSERT_EQ(section.FindVar("key")->AsInt(), 1);
+}
+
+TEST(ParserTestSuite, SameKeyInOtherSectionTest) {
+    Parser root = parse(std::string("key = 1\n[a]\nkey = 2\n[a.b]\nkey = 3\n"));
+
+    ASSERT_TRUE(root.valid());
+    ASSERT_EQ(root.Get("key").AsInt(), 1);
+    ASSERT_EQ(root.Get("a").Get("key").AsInt(), 2);
+    ASSERT_EQ(root.Get("a").Get("b").Get("key").AsInt(), 3);
+}
+
+TEST(ParserTestSuite, NestedArrayTest) {
+    Parser root = parse(std::string("key = [1, [\"a]\", true], 2.5, []]"));
+
+    ASSERT_TRUE(root.valid());
+    ASSERT_EQ(root.Get("key")[0].AsInt(), 1);
+    ASSERT_EQ(root.Get("key")[1][0].AsString(), "a]");
+    ASSERT_TRUE(root.Get("key")[1][1].AsBool());
+    ASSERT_FLOAT_EQ(root.Get("key")[2].AsFloat(), 2.5f);
+    ASSERT_EQ(root.Get("key")[3][0].AsIntOrDefault(7), 7);
+}
+
+TEST(ParserTestSuite, InvalidArrayTest) {
+    for (const char* data : {"key = [1, , 2]", "key = [1, 2,]", "key = [1 [2]]", "key = [[1] 2]", "key = [1, 2",
+                             "key = [1]]", "key = [1; 2]", "key = [abc]"}) {
+        ASSERT_FALSE(parse(std::string(data)).valid()) << data;
+    }
+}
+
+TEST(ParserTestSuite, MultiLineArrayTest) {
+    std::string data = "key = [\n  1, 2, # first\n  [3,\n 4],\n  \"x # y\"\n] # done\nnext = 5\n";
+
+    Parser root = parse(data);
+
+    ASSERT_TRUE(root.valid());
+    ASSERT_EQ(root.Get("key")[2][1].AsInt(), 4);
+    ASSERT_EQ(root.Get("key")[3].AsString(), "x # y");
+    ASSERT_EQ(root.Get("next").AsInt(), 5);
+}
+
+TEST(ParserTestSuite, StreamedArrayTest) {
+    std::istringstream stream("key = [1,\n2,\n[3]]\nnext = true\n");
+
+    Parser root = parse(stream);
+
+    ASSERT_TRUE(root.valid());
+    ASSERT_EQ(root.Get("key")[2][0].AsInt(), 3);
+    ASSERT_TRUE(root.Get("next").AsBool());
+}
+
+namespace {
+
+    std::vector<DIAGNOSTIC> Kinds(const Parser& parser) {
+        std::vector<DIAGNOSTIC> kinds;
+        for (const Diagnostic& diagnostic : parser.GetDiagnostics()) {
+            kinds.push_back(diagnostic.kind);
+        }
+        return kinds;
+    }
+
+}// namespace
+
+TEST(ParserTestSuite, DiagnosticsTest) {
+    Parser root = parse(std::string("a = 1\n  b c\nd = xyz\n[s..t]\nq = 1\n[ok]\nq = 2\nq = 3\nbad name = 4\n"));
+
+    ASSERT_FALSE(root.valid());
+    ASSERT_EQ(Kinds(root), (std::vector<DIAGNOSTIC>{UNKNOWN_LINE, INVALID_VALUE, INVALID_SECTION, DUPLICATE_KEY,
+                                                    INVALID_NAME}));
+    const std::vector<Diagnostic>& diagnostics = root.GetDiagnostics();
+    ASSERT_EQ(diagnostics[0].line, 2u);
+    ASSERT_EQ(diagnostics[0].column, 3u);
+    ASSERT_EQ(diagnostics[0].offset, 8u);
+    ASSERT_EQ(diagnostics[1].line, 3u);
+    ASSERT_EQ(diagnostics[1].column, 5u);
+    ASSERT_EQ(diagnostics[2].line, 4u);
+    ASSERT_EQ(diagnostics[3].line, 8u);
+    ASSERT_EQ(diagnostics[4].line, 9u);
+}
+
+TEST(ParserTestSuite, RecoveryKeepsValidLinesTest) {
+    Parser root = parse(std::string("a = 1\nb = ?\n[s..t]\nlost = 1\n[ok]\nz = 3\n"));
+
+    ASSERT_EQ(root.GetDiagnostics().size(), 2u);
+    ASSERT_EQ(root.Get("a").AsInt(), 1);
+    ASSERT_EQ(root.Get("ok").Get("z").AsInt(), 3);
+}
+
+TEST(ParserTestSuite, UnreadablePathTest) {
+    Parser root = parse(std::filesystem::path("does/not/exist.omfl"));
+
+    ASSERT_EQ(Kinds(root), std::vector<DIAGNOSTIC>{UNREADABLE_INPUT});
+}
+
+// Found by fuzzing: a comment that removes the '=' used to make TakeToStr
+// read before the start of the line.
+TEST(ParserTestSuite, CommentBeforeEqualsTest) {
+    Parser root = parse(std::string("key # = 1\n"));
+
+    ASSERT_EQ(Kinds(root), std::vector<DIAGNOSTIC>{UNKNOWN_LINE});
+}
+
+// Found by fuzzing: blanks before a line break inside an array used to be
+// dropped, joining the tokens on both sides.
+TEST(ParserTestSuite, TokenSplitByLineBreakTest) {
+    ASSERT_FALSE(parse(std::string("key = [1 \n 2]\n")).valid());
+}
+
+// Found by fuzzing: CountArrayElements rejected comments inside arrays that
+// the builder accepts.
+TEST(ParserTestSuite, CommentInsideArrayTest) {
+    Array* array = ParseArray("[1, # one\n 2]");
+
+    ASSERT_NE(array, nullptr);
+    ASSERT_EQ(array->Size(), 2u);
+    ASSERT_EQ((*array)[1].AsInt(), 2);
+}
+
+namespace {
+
+    Parser Limited(const std::string& data, void (*limit)(ParseOptions&)) {
+        ParseOptions options;
+        limit(options);
+        return parse(data, options);
+    }
+
+}// namespace
+
+TEST(ParserTestSuite, LimitsTest) {
+    std::vector<std::pair<std::string, DIAGNOSTIC>> cases = {
+        {"a = 1\nb = 2\n", INPUT_TOO_LARGE},
+        {"a = \"a long string value\"\n", LINE_TOO_LONG},
+        {"key = [[[[[1]]]]]\n", ARRAY_TOO_DEEP},
+        {"a = 1\nb = 2\nc = 3\nd = 4\n", TOO_MANY_NODES},
+        {"a = \"a long string value that is charged to the budget\"\n", ARENA_EXHAUSTED},
+    };
+    std::vector<void (*)(ParseOptions&)> limits = {
+        [](ParseOptions& options) { options.max_bytes = 4; },
+        [](ParseOptions& options) { options.max_line_length = 8; },
+        [](ParseOptions& options) { options.max_array_depth = 4; },
+        [](ParseOptions& options) { options.max_nodes = 2; },
+        [](ParseOptions& options) { options.max_arena_bytes = 16; },
+    };
+
+    for (size_t i = 0; i < cases.size(); i++) {
+        Parser parser = Limited(cases[i].first, limits[i]);
+        ASSERT_FALSE(parser.valid());
+        ASSERT_EQ(Kinds(parser), std::vector<DIAGNOSTIC>{cases[i].second}) << cases[i].first;
+    }
+}
+
+TEST(ParserTestSuite, WithinLimitsTest) {
+    ParseOptions options;
+    options.max_bytes = 64;
+    options.max_line_length = 32;
+    options.max_array_depth = 2;
+    options.max_nodes = 16;
+    Parser parser = parse(std::string("a = [[1, 2], [3]]\n[s]\nb = \"x\"\n"), options);
+
+    ASSERT_TRUE(parser.valid());
+    ASSERT_EQ(parser.Get("a")[1][0].AsInt(), 3);
+}
+
+TEST(ParserTestSuite, SectionsWithSameNameTest) {
+    Parser parser = parse(std::string("[a.b]\nx = 1\n[c.b]\nx = 2\n"));
+
+    ASSERT_TRUE(parser.valid());
+    ASSERT_EQ(parser.Get("a").Get("b").Get("x").AsInt(), 1);
+    ASSERT_EQ(parser.Get("c").Get("b").Get("x").AsInt(), 2);
+}
+
+TEST(ParserTestSuite, ContextReuseTest) {
+    ParserContext context;
+
+    Parser first = context.Parse(std::string("a = [1, [2, 3]]\n[s]\nb = \"first\"\n"));
+    Parser broken = context.Parse(std::string("a = [1, [2\nb c\n[x..y]\n"));
+    Parser second = context.Parse(std::string("[t]\nc = true\n"));
+
+    ASSERT_TRUE(first.valid());
+    ASSERT_EQ(first.Get("a")[1][1].AsInt(), 3);
+    ASSERT_EQ(first.Get("s").Get("b").AsString(), "first");
+    ASSERT_FALSE(broken.valid());
+    // Nothing from the earlier parses leaks into the next one.
+    ASSERT_TRUE(second.valid());
+    ASSERT_TRUE(second.GetDiagnostics().empty());
+    ASSERT_TRUE(second.Get("t").Get("c").AsBool());
+    ASSERT_EQ(second.Global().FindVar("a"), nullptr);
+    ASSERT_EQ(second.Global().FindChild("s"), nullptr);
+}
+
+TEST(ParserTestSuite, ContextMatchesParseTest) {
+    ParserContext context;
+    std::string data = "a = 1\n[s.t]\nb = [\"x\", 2.5]\n";
+
+    for (int i = 0; i < 3; i++) {
+        Parser parser = context.Parse(data);
+        ASSERT_TRUE(parser.valid());
+        ASSERT_EQ(parser.Get("a").AsInt(), parse(data).Get("a").AsInt());
+        ASSERT_EQ(parser.Get("s").Get("t").Get("b")[0].AsString(), "x");
+        ASSERT_FLOAT_EQ(parser.Get("s").Get("t").Get("b")[1].AsFloat(), 2.5f);
+    }
+}
+
+TEST(ParserTestSuite, EscapesTest) {
+    Parser parser = parse(std::string(R"(a = "q\"b\\s\/t\tn\nr\r"
+b = "Aé€"
+c = "😀"
+d = "# not a comment \" still" # a comment
+e = ["x\"y", "\u0042"]
+f = "\u00e9\u20AC\ud83d\ude00"
+)"));
+
+    ASSERT_TRUE(parser.valid());
+    ASSERT_EQ(parser.Get("a").AsString(), "q\"b\\s/t\tn\nr\r");
+    ASSERT_EQ(parser.Get("b").AsString(), "A\xc3\xa9\xe2\x82\xac");
+    ASSERT_EQ(parser.Get("c").AsString(), "\xf0\x9f\x98\x80");
+    ASSERT_EQ(parser.Get("d").AsString(), "# not a comment \" still");
+    ASSERT_EQ(parser.Get("e")[0].AsString(), "x\"y");
+    ASSERT_EQ(parser.Get("e")[1].AsString(), "B");
+    ASSERT_EQ(parser.Get("f").AsString(), "\xc3\xa9\xe2\x82\xac\xf0\x9f\x98\x80");
+}
+
+TEST(ParserTestSuite, InvalidEscapesTest) {
+    std::vector<std::string> values = {
+        R"("\x")", R"("\u12")", R"("\u12g4")", R"("\ud83d")", R"("\ude00")", R"("\ud83dA")",
+        R"("a"b")", R"("a\")",
+    };
+
+    for (const std::string& value : values) {
+        ASSERT_FALSE(parse("key = " + value + "\n").valid()) << value;
+    }
+}
+
+TEST(ParserTestSuite, Utf8Test) {
+    ASSERT_TRUE(ValidUtf8("plain ascii that is longer than sixteen bytes"));
+    ASSERT_TRUE(ValidUtf8("\xc3\xa9\xe2\x82\xac\xf0\x9f\x98\x80\xf4\x8f\xbf\xbf"));
+    ASSERT_FALSE(ValidUtf8("\xc0\xaf"));                          // overlong
+    ASSERT_FALSE(ValidUtf8("\xe0\x80\xaf"));                      // overlong
+    ASSERT_FALSE(ValidUtf8("\xed\xa0\x80"));                      // surrogate
+    ASSERT_FALSE(ValidUtf8("\xf4\x90\x80\x80"));                  // above U+10FFFF
+    ASSERT_FALSE(ValidUtf8("\xe2\x82"));                          // truncated
+    ASSERT_FALSE(ValidUtf8("sixteen bytes of ascii, then \xff")); // after a vector run
+
+    ASSERT_TRUE(parse(std::string("key = \"\xc3\xa9\"\n")).valid());
+    ASSERT_FALSE(parse(std::string("key = \"\xc3\x28\"\n")).valid());
+    ASSERT_FALSE(parse(std::string("key = [\"\xed\xa0\x80\"]\n")).valid());
+}
+
+TEST(ParserTestSuite, DecodeStringTest) {
+    std::string storage = "untouched";
+    std::string_view text;
+
+    ASSERT_TRUE(DecodeString("no escapes", text, &storage));
+    ASSERT_EQ(text, "no escapes");
+    ASSERT_EQ(storage, "untouched");
+
+    ASSERT_TRUE(DecodeString(R"(a\nb)", text, &storage));
+    ASSERT_EQ(text, "a\nb");
+    ASSERT_EQ(text.data(), storage.data());
+
+    ASSERT_TRUE(DecodeString(R"(a\tb)", text, nullptr));
+    ASSERT_FALSE(DecodeString(R"(a\qb)", text, nullptr));
+}
+
+TEST(ParserTestSuite, InvalidMultiLineArrayTest) {
+    Parser parser = parse(std::string("key = [1,\n x,\n 3,\n 4]\nnext = 2\n"));
+
+    ASSERT_EQ(Kinds(parser), std::vector<DIAGNOSTIC>{INVALID_ARRAY});
+    ASSERT_EQ(parser.GetDiagnostics()[0].line, 2u);
+    ASSERT_EQ(parser.Get("next").AsInt(), 2);
+    ASSERT_EQ(parser.Global().FindVar("key"), nullptr);
+}
+
+TEST(ParserTestSuite, InvalidStreamedArrayTest) {
+    std::istringstream stream("key = [[1,\n \"a\" \"b\"],\n [3]]\nnext = 2\n");
+    Parser parser = parse(stream);
+
+    ASSERT_EQ(Kinds(parser), std::vector<DIAGNOSTIC>{INVALID_ARRAY});
+    ASSERT_EQ(parser.Get("next").AsInt(), 2);
+}
+
+TEST(ParserTestSuite, RejectedLineSkipsItsArrayTest) {
+    for (const char* data : {"bad name = [1,\n2,\n3]\nnext = 1\n", "key = 1\nkey = [1,\n2,\n3]\nnext = 1\n",
+                             "= [1,\n2]\nnext = 1\n"}) {
+        Parser parser = parse(std::string(data));
+
+        ASSERT_EQ(parser.GetDiagnostics().size(), 1u) << data;
+        ASSERT_EQ(parser.Get("next").AsInt(), 1) << data;
+    }
+}
+
+TEST(ParserTestSuite, ArrayElementPositionTest) {
+    Parser single = parse(std::string("a = [99999999999]\n"));
+    ASSERT_EQ(Kinds(single), std::vector<DIAGNOSTIC>{INVALID_ARRAY});
+    ASSERT_EQ(single.GetDiagnostics()[0].offset, 5u);
+    ASSERT_EQ(single.GetDiagnostics()[0].column, 6u);
+
+    Parser later = parse(std::string("x = 1\na = [1,\n  [2, bad],\n 3]\n"));
+    ASSERT_EQ(Kinds(later), std::vector<DIAGNOSTIC>{INVALID_ARRAY});
+    ASSERT_EQ(later.GetDiagnostics()[0].line, 3u);
+    ASSERT_EQ(later.GetDiagnostics()[0].column, 7u);
+    ASSERT_EQ(later.GetDiagnostics()[0].offset, 20u);
+
+    // An element split by a line break is reported where it starts.
+    Parser split = parse(std::string("a = [1\n 2]\n"));
+    ASSERT_EQ(Kinds(split), std::vector<DIAGNOSTIC>{INVALID_ARRAY});
+    ASSERT_EQ(split.GetDiagnostics()[0].line, 1u);
+    ASSERT_EQ(split.GetDiagnostics()[0].column, 6u);
+}
@@ -0,0 +1,67 @@
+#include <lib/parser.h>
+
+#include <gtest/gtest.h>
+
+using namespace omfl;
+
+namespace {
+
+    const std::string kServers = "name = \"root\"\n"
+                                 "[servers.first]\nip = \"1.1.1.1\"\nport = 80\n"
+                                 "[servers.second]\nip = \"2.2.2.2\"\n"
+                                 "[servers.second.backup]\nip = \"3.3.3.3\"\n"
+                                 "[clients]\nip = \"4.4.4.4\"\n";
+
+    std::string Describe(const Match& match) {
+        if (match.variable != nullptr) {
+            return match.section->GetName() + ":" + match.variable->GetName();
+        }
+        return match.section->GetName();
+    }
+
+    std::vector<std::string> Collect(const Query& query) {
+        std::vector<std::string> result;
+        for (const Match& match : query) {
+            result.push_back(Describe(match));
+        }
+        return result;
+    }
+
+}// namespace
+
+TEST(QueryTestSuite, LiteralTest) {
+    Parser parser = parse(kServers);
+
+    ASSERT_EQ(Collect(parser.Find("servers.first.port")), std::vector<std::string>{"first:port"});
+    ASSERT_EQ(Collect(parser.Find("servers.second")), std::vector<std::string>{"second"});
+    ASSERT_TRUE(Collect(parser.Find("servers.third.ip")).empty());
+}
+
+TEST(QueryTestSuite, StarTest) {
+    Parser parser = parse(kServers);
+
+    ASSERT_EQ(Collect(parser.Find("servers.*.ip")), (std::vector<std::string>{"first:ip", "second:ip"}));
+    ASSERT_EQ(Collect(parser.Find("*.ip")), std::vector<std::string>{"clients:ip"});
+}
+
+TEST(QueryTestSuite, DoubleStarTest) {
+    Parser parser = parse(kServers);
+
+    ASSERT_EQ(Collect(parser.Find("**.ip")),
+              (std::vector<std::string>{"first:ip", "second:ip", "backup:ip", "clients:ip"}));
+    ASSERT_EQ(Collect(parser.Find("servers.**.ip")),
+              (std::vector<std::string>{"first:ip", "second:ip", "backup:ip"}));
+    // '**' followed by '**' must not report a node twice.
+    ASSERT_EQ(Collect(parser.Find("**.**.backup")), std::vector<std::string>{"backup"});
+}
+
+TEST(QueryTestSuite, ForEachUnderTest) {
+    Parser parser = parse(kServers);
+    std::vector<std::string> visited;
+
+    parser.ForEachUnder("servers.second", [&visited](const Match& match) {
+        visited.push_back(Describe(match));
+    });
+
+    ASSERT_EQ(visited, (std::vector<std::string>{"second:ip", "backup", "backup:ip"}));
+}
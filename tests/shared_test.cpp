@@ -0,0 +1,80 @@
+#include <lib/shared.h>
+
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+
+using namespace omfl;
+
+namespace {
+
+    class SharedTestSuite : public testing::Test {
+    protected:
+        std::string name_ = "omfl-test-" + std::to_string(getpid());
+        SharedPublisher publisher_{name_};
+
+        void TearDown() override {
+            publisher_.Unlink();
+        }
+    };
+
+}// namespace
+
+TEST_F(SharedTestSuite, RoundTripTest) {
+    Parser parser = parse(std::string("title = \"config\"\n[servers.first]\nport = 80\nratio = 0.5\n"
+                                      "enabled = true\nhosts = [\"a\", [1, 2]]\n"));
+    ASSERT_EQ(publisher_.Publish(parser), 1u);
+
+    SharedReader reader(name_);
+
+    ASSERT_EQ(reader.Generation(), 1u);
+    ASSERT_EQ(reader.Get("title").AsString(), "config");
+    SharedElement first = reader.Get("servers.first");
+    ASSERT_TRUE(first.IsSection());
+    ASSERT_EQ(first.Get("port").AsInt(), 80);
+    ASSERT_FLOAT_EQ(first.Get("ratio").AsFloat(), 0.5f);
+    ASSERT_TRUE(first.Get("enabled").AsBool());
+    ASSERT_EQ(first.Get("hosts")[0].AsStringView(), "a");
+    ASSERT_EQ(first.Get("hosts")[1][1].AsInt(), 2);
+    ASSERT_FALSE(first.Get("hosts")[2].IsInt());
+    ASSERT_THROW(static_cast<void>(reader.Get("servers.missing")), std::invalid_argument);
+    ASSERT_THROW(first.Get("port").AsString(), std::invalid_argument);
+}
+
+TEST_F(SharedTestSuite, RefreshTest) {
+    Parser first = parse(std::string("version = 1\n"));
+    Parser second = parse(std::string("version = 2\n"));
+    publisher_.Publish(first);
+    SharedReader reader(name_);
+
+    ASSERT_FALSE(reader.Refresh());
+    ASSERT_EQ(publisher_.Publish(second), 2u);
+    // The reader keeps the generation it attached to until it refreshes.
+    ASSERT_EQ(reader.Get("version").AsInt(), 1);
+    ASSERT_TRUE(reader.Refresh());
+    ASSERT_EQ(reader.Generation(), 2u);
+    ASSERT_EQ(reader.Get("version").AsInt(), 2);
+}
+
+TEST_F(SharedTestSuite, NothingPublishedTest) {
+    SharedReader reader(name_);
+
+    ASSERT_EQ(reader.Generation(), 0u);
+    ASSERT_FALSE(reader.Refresh());
+    ASSERT_THROW(static_cast<void>(reader.Get("version")), std::invalid_argument);
+}
+
+TEST(SharedReaderTestSuite, MissingTest) {
+    ASSERT_THROW(SharedReader("omfl-test-does-not-exist"), std::system_error);
+    ASSERT_THROW(SharedReader("bad/name"), std::invalid_argument);
+}
+
+TEST_F(SharedTestSuite, ConstDocumentWithoutArraysTest) {
+    const Parser parser = parse(std::string("[s]\nb = \"x\"\n"));
+
+    ASSERT_EQ(publisher_.Publish(parser), 1u);
+    SharedReader reader(name_);
+
+    ASSERT_EQ(reader.Get("s.b").AsString(), "x");
+    ASSERT_THROW(static_cast<void>(reader.Get("a")), std::invalid_argument);
+}